@@ -117,6 +117,17 @@ BENCHMARK_CAPTURE(bm_5_tokenizer, all_first, all_first);
 BENCHMARK_CAPTURE(bm_5_tokenizer, punctuation, punctuation);
 BENCHMARK_CAPTURE(bm_5_tokenizer, punctuation_ws, punctuation_ws);
 
+template <unsigned N>
+void bm_6_tokenizer_dfa(benchmark::State& state, const char (&array)[N])
+{
+    benchmark_impl(&tokenizer_dfa, state, array, array + N - 1);
+}
+BENCHMARK_CAPTURE(bm_6_tokenizer_dfa, all_error, all_error);
+BENCHMARK_CAPTURE(bm_6_tokenizer_dfa, all_last, all_last);
+BENCHMARK_CAPTURE(bm_6_tokenizer_dfa, all_first, all_first);
+BENCHMARK_CAPTURE(bm_6_tokenizer_dfa, punctuation, punctuation);
+BENCHMARK_CAPTURE(bm_6_tokenizer_dfa, punctuation_ws, punctuation_ws);
+
 int main(int argc, char* argv[])
 {
     // a reporter that generates an HTML table output
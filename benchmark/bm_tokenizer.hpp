@@ -12,10 +12,18 @@ namespace tokenizer_ns
 {
 namespace lex = foonathan::lex;
 
-using token_spec
-    = lex::token_spec<struct ellipsis, struct dot, struct plus_eq, struct plus_plus, struct plus,
-                      struct arrow_deref, struct arrow, struct minus_minus, struct minus_eq,
-                      struct minus, struct tilde, struct whitespace>;
+template <class Backend>
+struct whitespace;
+
+// the same tokens, matched by the given backend
+template <class Backend>
+struct token_spec
+: lex::token_spec<struct ellipsis, struct dot, struct plus_eq, struct plus_plus, struct plus,
+                  struct arrow_deref, struct arrow, struct minus_minus, struct minus_eq,
+                  struct minus, struct tilde, whitespace<Backend>>
+{
+    using backend = Backend;
+};
 
 struct ellipsis : lex::literal_token<'.', '.', '.'>
 {};
@@ -50,21 +58,19 @@ struct minus : lex::literal_token<'-'>
 struct tilde : lex::literal_token<'~'>
 {};
 
-struct whitespace : lex::rule_token<whitespace, token_spec>
+template <class Backend>
+struct whitespace : lex::rule_token<whitespace<Backend>, token_spec<Backend>>
 {
     static constexpr auto rule() noexcept
     {
         return lex::token_rule::star(lex::ascii::is_space);
     }
 };
-} // namespace tokenizer_ns
 
-void tokenizer(const char* str, const char* end, void (*f)(int, foonathan::lex::token_spelling))
+template <class Backend>
+void tokenize(const char* str, const char* end, void (*f)(int, lex::token_spelling))
 {
-    using namespace tokenizer_ns;
-    namespace lex = foonathan::lex;
-
-    lex::tokenizer<token_spec> tokenizer(str, end);
+    lex::tokenizer<token_spec<Backend>> tokenizer(str, end);
     while (!tokenizer.is_done())
     {
         auto cur = tokenizer.peek();
@@ -73,5 +79,17 @@ void tokenizer(const char* str, const char* end, void (*f)(int, foonathan::lex::
         tokenizer.bump();
     }
 }
+} // namespace tokenizer_ns
+
+void tokenizer(const char* str, const char* end, void (*f)(int, foonathan::lex::token_spelling))
+{
+    tokenizer_ns::tokenize<foonathan::lex::trie_backend>(str, end, f);
+}
+
+void tokenizer_dfa(const char* str, const char* end,
+                   void (*f)(int, foonathan::lex::token_spelling))
+{
+    tokenizer_ns::tokenize<foonathan::lex::dfa_backend>(str, end, f);
+}
 
 #endif // FOONATHAN_LEX_BM_TOKENIZER_HPP_INCLUDED
@@ -62,7 +62,8 @@ void trie(const char* str, const char* end, void (*f)(int, foonathan::lex::token
     using namespace trie_ns;
     namespace lex = foonathan::lex;
 
-    using trie = lex::detail::literal_trie<literals, literals>;
+    using trie = lex::detail::trie<literals>::build<
+        lex::detail::literal_list<literals, literals::list>>;
     while (str != end)
     {
         // don't call function directly,
@@ -0,0 +1,163 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// Measures the compile-time cost of token specifications of increasing size,
+// by compiling `compile_time_spec.cpp` with different configurations.
+//
+// Usage: foonathan_lex_compile_benchmark [additional compiler flags...]
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#    define FOONATHAN_LEX_DETAIL_POSIX 1
+#endif
+
+// set by CMake
+#ifndef FOONATHAN_LEX_COMPILER
+#    define FOONATHAN_LEX_COMPILER "c++"
+#endif
+#ifndef FOONATHAN_LEX_COMPILE_SOURCE
+#    define FOONATHAN_LEX_COMPILE_SOURCE "compile_time_spec.cpp"
+#endif
+// include directories, separated by `|`
+#ifndef FOONATHAN_LEX_COMPILE_INCLUDES
+#    define FOONATHAN_LEX_COMPILE_INCLUDES ""
+#endif
+
+namespace
+{
+struct configuration
+{
+    const char* kind; // literals or keywords
+    std::size_t count;
+    std::size_t padding;
+};
+
+// literals and keywords are stored in different data structures, so they're measured separately
+const configuration configurations[]
+    = {{"literals", 50, 0}, {"literals", 200, 0}, {"literals", 500, 0}, {"literals", 1000, 0},
+       {"literals", 50, 8}, {"literals", 200, 8}, {"literals", 500, 8}, {"literals", 1000, 8},
+       {"keywords", 50, 0}, {"keywords", 200, 0}, {"keywords", 500, 0}, {"keywords", 1000, 0}};
+
+struct measurement
+{
+    bool        success;
+    double      seconds;
+    std::size_t peak_memory_kib;
+    std::size_t object_size;
+};
+
+std::vector<std::string> split_includes(const std::string& str)
+{
+    std::vector<std::string> result;
+    std::string::size_type   begin = 0;
+    while (begin < str.size())
+    {
+        auto end = str.find('|', begin);
+        if (end == std::string::npos)
+            end = str.size();
+        if (end != begin)
+            result.push_back("-I" + str.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return result;
+}
+
+#if defined(FOONATHAN_LEX_DETAIL_POSIX)
+std::size_t file_size(const char* path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? static_cast<std::size_t>(file.tellg()) : 0u;
+}
+
+// runs the compiler and measures the time and peak memory of it and its sub-processes
+measurement compile(std::vector<std::string> arguments, const char* object)
+{
+    std::vector<char*> argv;
+    for (auto& arg : arguments)
+        argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+
+    std::remove(object);
+    auto begin = std::chrono::steady_clock::now();
+    auto pid   = fork();
+    if (pid == 0)
+    {
+        // only the exit status is interesting, not the diagnostics
+        std::freopen("/dev/null", "w", stderr);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int    status = 0;
+    rusage usage{};
+    auto   result = pid > 0 ? wait4(pid, &status, 0, &usage) : -1;
+    auto   end    = std::chrono::steady_clock::now();
+
+    measurement m;
+    m.success = result == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    m.seconds = std::chrono::duration<double>(end - begin).count();
+#    if defined(__APPLE__)
+    m.peak_memory_kib = static_cast<std::size_t>(usage.ru_maxrss) / 1024u;
+#    else
+    m.peak_memory_kib = static_cast<std::size_t>(usage.ru_maxrss);
+#    endif
+    m.object_size = m.success ? file_size(object) : 0u;
+    return m;
+}
+#endif
+} // namespace
+
+int main(int argc, char* argv[])
+{
+#if defined(FOONATHAN_LEX_DETAIL_POSIX)
+    const char* object = "foonathan_lex_compile_benchmark.o";
+
+    std::printf("| %-8s | %5s | %7s | %8s | %10s | %10s |\n", "tokens", "count", "padding",
+                "time", "memory", "object");
+    std::printf("|----------|------:|--------:|---------:|-----------:|-----------:|\n");
+    for (auto& config : configurations)
+    {
+        std::vector<std::string> arguments = {FOONATHAN_LEX_COMPILER, "-std=c++14", "-O2"};
+        for (auto& include : split_includes(FOONATHAN_LEX_COMPILE_INCLUDES))
+            arguments.push_back(include);
+        for (auto i = 1; i < argc; ++i)
+            arguments.push_back(argv[i]);
+
+        auto keywords = std::string(config.kind) == "keywords";
+        arguments.push_back("-DFOONATHAN_LEX_BENCHMARK_LITERALS="
+                            + std::to_string(keywords ? 0u : config.count));
+        arguments.push_back("-DFOONATHAN_LEX_BENCHMARK_KEYWORDS="
+                            + std::to_string(keywords ? config.count : 0u));
+        arguments.push_back("-DFOONATHAN_LEX_BENCHMARK_PADDING=" + std::to_string(config.padding));
+        arguments.push_back("-c");
+        arguments.push_back(FOONATHAN_LEX_COMPILE_SOURCE);
+        arguments.push_back("-o");
+        arguments.push_back(object);
+
+        auto m = compile(arguments, object);
+        if (m.success)
+            std::printf("| %-8s | %5zu | %7zu | %6.2f s | %6zu MiB | %6zu KiB |\n", config.kind,
+                        config.count, config.padding, m.seconds, m.peak_memory_kib / 1024u,
+                        m.object_size / 1024u);
+        else
+            std::printf("| %-8s | %5zu | %7zu | %6.2f s | %10s | %10s |\n", config.kind,
+                        config.count, config.padding, m.seconds, "failed", "-");
+        std::fflush(stdout);
+    }
+    std::remove(object);
+#else
+    (void)argc;
+    (void)argv;
+    std::fprintf(stderr, "the compile-time benchmark requires a POSIX system\n");
+    return 1;
+#endif
+}
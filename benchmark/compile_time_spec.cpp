@@ -0,0 +1,108 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// A token specification with a configurable number of generated tokens.
+// It is compiled by `compile_time.cpp` to measure the compile-time cost of the library.
+//
+// * `FOONATHAN_LEX_BENCHMARK_LITERALS`: the number of literal tokens
+// * `FOONATHAN_LEX_BENCHMARK_KEYWORDS`: the number of keyword tokens
+// * `FOONATHAN_LEX_BENCHMARK_PADDING`: the number of characters appended to each token,
+//   the depth of the trie is that plus the few characters that distinguish the tokens
+
+#include <cstddef>
+#include <utility>
+
+#include <foonathan/lex/ascii.hpp>
+#include <foonathan/lex/tokenizer.hpp>
+
+#ifndef FOONATHAN_LEX_BENCHMARK_LITERALS
+#    define FOONATHAN_LEX_BENCHMARK_LITERALS 50
+#endif
+#ifndef FOONATHAN_LEX_BENCHMARK_KEYWORDS
+#    define FOONATHAN_LEX_BENCHMARK_KEYWORDS 0
+#endif
+#ifndef FOONATHAN_LEX_BENCHMARK_PADDING
+#    define FOONATHAN_LEX_BENCHMARK_PADDING 0
+#endif
+
+namespace lex = foonathan::lex;
+
+namespace
+{
+// The characters of a token are the digits of its index, followed by the padding.
+// Literals use punctuation, so they don't conflict with identifiers.
+constexpr const char  literal_digits[] = "!#$%&*+,-./:<=>?";
+constexpr const char  keyword_digits[] = "abcdefghijklmnop";
+constexpr std::size_t base             = 16;
+
+constexpr std::size_t digit_count(std::size_t index)
+{
+    return index < base ? 1 : 1 + digit_count(index / base);
+}
+
+constexpr char token_char(const char* digits, char padding, std::size_t index, std::size_t i)
+{
+    if (i >= digit_count(index))
+        return padding;
+
+    for (auto n = digit_count(index) - 1 - i; n != 0; --n)
+        index /= base;
+    return digits[index % base];
+}
+
+template <std::size_t Index,
+          typename = std::make_index_sequence<digit_count(Index) + FOONATHAN_LEX_BENCHMARK_PADDING>>
+struct literal;
+template <std::size_t Index, std::size_t... I>
+struct literal<Index, std::index_sequence<I...>>
+: lex::literal_token<token_char(literal_digits, '@', Index, I)...>
+{};
+
+template <std::size_t Index,
+          typename = std::make_index_sequence<digit_count(Index) + FOONATHAN_LEX_BENCHMARK_PADDING>>
+struct keyword;
+template <std::size_t Index, std::size_t... I>
+struct keyword<Index, std::index_sequence<I...>>
+: lex::keyword_token<token_char(keyword_digits, 'z', Index, I)...>
+{};
+
+template <class Literals, class Keywords>
+struct make_spec;
+template <std::size_t... Literals, std::size_t... Keywords>
+struct make_spec<std::index_sequence<Literals...>, std::index_sequence<Keywords...>>
+{
+    using type = lex::token_spec<struct whitespace, struct identifier, literal<Literals>...,
+                                 keyword<Keywords>...>;
+};
+
+using spec =
+    typename make_spec<std::make_index_sequence<FOONATHAN_LEX_BENCHMARK_LITERALS>,
+                       std::make_index_sequence<FOONATHAN_LEX_BENCHMARK_KEYWORDS>>::type;
+
+struct whitespace : lex::rule_token<whitespace, spec>, lex::whitespace_token
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::star(lex::ascii::is_space);
+    }
+};
+
+struct identifier : lex::identifier_token<identifier, spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::plus(lex::ascii::is_alpha);
+    }
+};
+} // namespace
+
+// instantiates the entire tokenizer
+std::size_t tokenize(const char* begin, const char* end)
+{
+    std::size_t          result = 0;
+    lex::tokenizer<spec> tokenizer(begin, end);
+    while (!tokenizer.is_done())
+        result += tokenizer.get().kind().get();
+    return result;
+}
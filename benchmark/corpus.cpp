@@ -0,0 +1,703 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// Benchmarks the tokenizer of `example/ctokenizer.cpp` and the parser of `example/calculator.cpp`
+// on generated inputs that look like actual source code.
+//
+// Usage: foonathan_lex_corpus_benchmark [max size, e.g. 32K, 64M or 1G; default 1G]
+
+#define FOONATHAN_LEX_EXAMPLE_NO_MAIN
+#include "../example/calculator.cpp"
+#include "../example/ctokenizer.cpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    define FOONATHAN_LEX_DETAIL_POSIX 1
+#    include <sys/resource.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#else
+#    define FOONATHAN_LEX_DETAIL_POSIX 0
+#endif
+
+namespace lex = foonathan::lex;
+
+namespace
+{
+//=== corpus generation ===//
+// deterministic, so every run uses the same corpus
+class generator
+{
+public:
+    explicit generator(unsigned seed) : engine_(seed) {}
+
+    // a number in [0, max)
+    std::size_t number(std::size_t max)
+    {
+        return static_cast<std::size_t>(engine_()) % max;
+    }
+
+    bool chance(std::size_t percent)
+    {
+        return number(100) < percent;
+    }
+
+    template <std::size_t N>
+    const char* pick(const char* const (&options)[N])
+    {
+        return options[number(N)];
+    }
+
+private:
+    std::minstd_rand engine_;
+};
+
+namespace c_corpus
+{
+    const char* const types[]      = {"int",   "long",   "unsigned", "char*",  "const char*",
+                                      "void*", "double", "float",    "size_t", "struct node*"};
+    const char* const names[]      = {"count",  "buffer", "result", "index", "node", "value",
+                                      "length", "data",   "ptr",    "next",  "size", "flags",
+                                      "begin",  "end",    "state",  "key",   "i",    "j"};
+    const char* const functions[]  = {"strlen", "memcpy", "malloc", "free",
+                                      "printf", "hash",   "lookup", "insert_node"};
+    const char* const binary_ops[] = {"+", "-",  "*",  "/", "%",  "<<", ">>", "&",  "|",
+                                      "^", "==", "!=", "<", "<=", ">",  ">=", "&&", "||"};
+    const char* const assign_ops[] = {"=", "+=", "-=", "*=", "/=", "|=", "&=", "^=", "<<=", ">>="};
+    const char* const literals[]   = {"0",    "1",       "42",  "1024", "0xFF", "0x7fffffffUL",
+                                      "3.14", "1.5e-3f", "'a'", "'\\n'", "'\\0'", "NULL",
+                                      "\"hello, world\\n\"", "\"%s: %d\\n\""};
+    const char* const comments[]   = {"check the bounds first", "TODO: this could be faster",
+                                      "the node is owned by the caller", "see the comment above",
+                                      "advance to the next element"};
+
+    void identifier(generator& gen, std::string& out)
+    {
+        out += gen.pick(names);
+        if (gen.chance(30))
+        {
+            out += '_';
+            out += std::to_string(gen.number(100));
+        }
+    }
+
+    void expression(generator& gen, std::string& out, int depth)
+    {
+        auto kind = depth > 2 ? gen.number(3) : gen.number(8);
+        if (kind == 0)
+            out += gen.pick(literals);
+        else if (kind <= 2)
+            identifier(gen, out);
+        else if (kind == 3)
+        {
+            identifier(gen, out);
+            out += gen.chance(50) ? "->" : ".";
+            out += gen.pick(names);
+        }
+        else if (kind == 4)
+        {
+            identifier(gen, out);
+            out += '[';
+            expression(gen, out, depth + 1);
+            out += ']';
+        }
+        else if (kind == 5)
+        {
+            out += gen.pick(functions);
+            out += '(';
+            for (auto i = gen.number(4); i != 0; --i)
+            {
+                expression(gen, out, depth + 1);
+                if (i != 1)
+                    out += ", ";
+            }
+            out += ')';
+        }
+        else if (kind == 6)
+        {
+            out += '(';
+            expression(gen, out, depth + 1);
+            out += ')';
+        }
+        else
+        {
+            if (gen.chance(20))
+                out += gen.chance(50) ? "!" : "~";
+            expression(gen, out, depth + 1);
+            out += ' ';
+            out += gen.pick(binary_ops);
+            out += ' ';
+            expression(gen, out, depth + 1);
+        }
+    }
+
+    void indent(std::string& out, int level)
+    {
+        out.append(static_cast<std::size_t>(level) * 4, ' ');
+    }
+
+    void statement(generator& gen, std::string& out, int level)
+    {
+        auto kind = level > 2 ? gen.number(4) : gen.number(8);
+        indent(out, level);
+        if (kind == 0)
+        {
+            out += gen.pick(types);
+            out += ' ';
+            identifier(gen, out);
+            out += " = ";
+            expression(gen, out, 0);
+            out += ";\n";
+        }
+        else if (kind == 1)
+        {
+            identifier(gen, out);
+            out += ' ';
+            out += gen.pick(assign_ops);
+            out += ' ';
+            expression(gen, out, 0);
+            out += ";\n";
+        }
+        else if (kind == 2)
+        {
+            identifier(gen, out);
+            out += gen.chance(50) ? "++;\n" : "--;\n";
+        }
+        else if (kind == 3)
+        {
+            if (gen.chance(50))
+            {
+                out += "// ";
+                out += gen.pick(comments);
+                out += '\n';
+            }
+            else
+            {
+                out += "/* ";
+                out += gen.pick(comments);
+                out += " */\n";
+            }
+        }
+        else if (kind <= 5)
+        {
+            out += "if (";
+            expression(gen, out, 0);
+            out += ")\n";
+            indent(out, level);
+            out += "{\n";
+            for (auto i = 1 + gen.number(4); i != 0; --i)
+                statement(gen, out, level + 1);
+            indent(out, level);
+            out += "}\n";
+            if (gen.chance(30))
+            {
+                indent(out, level);
+                out += "else\n";
+                statement(gen, out, level + 1);
+            }
+        }
+        else if (kind == 6)
+        {
+            out += "for (int i = 0; i < ";
+            expression(gen, out, 1);
+            out += "; ++i)\n";
+            indent(out, level);
+            out += "{\n";
+            for (auto i = 1 + gen.number(4); i != 0; --i)
+                statement(gen, out, level + 1);
+            indent(out, level);
+            out += "}\n";
+        }
+        else
+        {
+            out += "while (";
+            expression(gen, out, 0);
+            out += ")\n";
+            statement(gen, out, level + 1);
+        }
+    }
+
+    void function(generator& gen, std::string& out)
+    {
+        out += "/* ";
+        out += gen.pick(comments);
+        out += ".\n * ";
+        out += gen.pick(comments);
+        out += ".\n */\n";
+
+        out += gen.chance(50) ? "static " : "";
+        out += gen.pick(types);
+        out += ' ';
+        out += gen.pick(functions);
+        out += '_';
+        out += std::to_string(gen.number(10000));
+        out += '(';
+        for (auto i = 1 + gen.number(3); i != 0; --i)
+        {
+            out += gen.pick(types);
+            out += ' ';
+            identifier(gen, out);
+            if (i != 1)
+                out += ", ";
+        }
+        out += ")\n{\n";
+        for (auto i = 3 + gen.number(8); i != 0; --i)
+            statement(gen, out, 1);
+        out += "    return ";
+        expression(gen, out, 1);
+        out += ";\n}\n\n";
+    }
+
+    // C functions until the corpus has at least the given size
+    std::string generate(std::size_t size)
+    {
+        generator   gen(42);
+        std::string result;
+        result.reserve(size + 4096);
+        while (result.size() < size)
+            function(gen, result);
+        return result;
+    }
+} // namespace c_corpus
+
+namespace calculator_corpus
+{
+    // The grammar doesn't allow mixing arithmetic and bitwise operators without parentheses.
+    const char* const math_ops[] = {" + ", " - ", " * ", " / ", " ** "};
+    const char* const bit_ops[]  = {" & ", " | "};
+
+    void atom(generator& gen, std::string& out, int depth);
+
+    void expression(generator& gen, std::string& out, int depth)
+    {
+        auto bitwise = gen.chance(20);
+        for (auto i = 1 + gen.number(depth > 1 ? 2 : 4); i != 0; --i)
+        {
+            if (bitwise && gen.chance(20))
+                out += '~';
+            else if (!bitwise && gen.chance(10))
+                out += '-';
+            atom(gen, out, depth);
+
+            if (i != 1)
+                out += bitwise ? gen.pick(bit_ops) : gen.pick(math_ops);
+        }
+    }
+
+    void atom(generator& gen, std::string& out, int depth)
+    {
+        auto kind = depth > 2 ? gen.number(2) : gen.number(3);
+        if (kind == 0)
+            out += std::to_string(1 + gen.number(1000));
+        else if (kind == 1)
+            out += static_cast<char>('a' + gen.number(26));
+        else
+        {
+            out += '(';
+            expression(gen, out, depth + 1);
+            out += ')';
+        }
+    }
+
+    // a line of the REPL, i.e. a list of declarations
+    void line(generator& gen, std::string& out)
+    {
+        for (auto i = 1 + gen.number(4); i != 0; --i)
+        {
+            if (gen.chance(60))
+            {
+                out += static_cast<char>('a' + gen.number(26));
+                out += " := ";
+            }
+            expression(gen, out, 0);
+            if (i != 1 || gen.chance(50))
+                out += "; ";
+        }
+        out += '\n';
+    }
+
+    std::string generate(std::size_t size)
+    {
+        generator   gen(42);
+        std::string result;
+        result.reserve(size + 4096);
+        while (result.size() < size)
+            line(gen, result);
+        return result;
+    }
+} // namespace calculator_corpus
+
+//=== measurement ===//
+using benchmark_clock = std::chrono::steady_clock;
+
+// the tokens are timed in batches, as the clock is too coarse for a single token
+constexpr std::size_t batch_tokens = 1024;
+
+struct measurement
+{
+    std::size_t bytes   = 0;
+    std::size_t tokens  = 0;
+    double      seconds = 0;
+    // the time per token of each batch
+    std::vector<double> ns_per_token;
+    // tokens or lines that were invalid, they indicate a bug in the generator
+    std::size_t errors = 0;
+
+    void add_batch(benchmark_clock::time_point begin, benchmark_clock::time_point end,
+                   std::size_t tokens_in_batch)
+    {
+        auto ns = std::chrono::duration<double, std::nano>(end - begin).count();
+        seconds += ns / 1e9;
+        tokens += tokens_in_batch;
+        if (tokens_in_batch > 0)
+            ns_per_token.push_back(ns / static_cast<double>(tokens_in_batch));
+    }
+
+    double percentile(double p)
+    {
+        if (ns_per_token.empty())
+            return 0;
+        auto index = static_cast<std::size_t>(p * static_cast<double>(ns_per_token.size()));
+        index      = std::min(index, ns_per_token.size() - 1);
+        std::nth_element(ns_per_token.begin(), ns_per_token.begin() + std::ptrdiff_t(index),
+                         ns_per_token.end());
+        return ns_per_token[index];
+    }
+};
+
+// keeps the compiler from optimizing the results away
+volatile std::size_t sink;
+
+void tokenize_c(const std::string& corpus, measurement& m)
+{
+    lex::tokenizer<C::spec> tokenizer(corpus.data(), corpus.size());
+    std::size_t             checksum = 0;
+    while (!tokenizer.is_done())
+    {
+        auto begin = benchmark_clock::now();
+        auto count = std::size_t(0);
+        for (; count != batch_tokens && !tokenizer.is_done(); ++count)
+        {
+            auto token = tokenizer.get();
+            checksum += token.kind().get() + token.spelling().size();
+            if (token.is(lex::error_token{}))
+                ++m.errors;
+        }
+        m.add_batch(begin, benchmark_clock::now(), count);
+    }
+    m.bytes += corpus.size();
+    sink = checksum;
+}
+
+// evaluates the expressions like the interpreter of the example,
+// but with unsigned arithmetic, so overflow isn't undefined
+struct calculator_visitor
+{
+    unsigned    variables[256] = {};
+    std::size_t errors         = 0;
+
+    unsigned operator()(grammar::atom_expr, lex::static_token<grammar::number, int> number)
+    {
+        return static_cast<unsigned>(number.value());
+    }
+    unsigned operator()(grammar::atom_expr, lex::static_token<grammar::var, char> var)
+    {
+        return variables[static_cast<unsigned char>(var.value())];
+    }
+
+    unsigned operator()(lex::callback_result_of<grammar::expr>);
+    unsigned operator()(grammar::expr, unsigned atom)
+    {
+        return atom;
+    }
+    unsigned operator()(grammar::expr, grammar::plus, unsigned rhs)
+    {
+        return rhs;
+    }
+    unsigned operator()(grammar::expr, grammar::minus, unsigned rhs)
+    {
+        return 0u - rhs;
+    }
+    unsigned operator()(grammar::expr, grammar::tilde, unsigned rhs)
+    {
+        return ~rhs;
+    }
+    unsigned operator()(grammar::expr, unsigned lhs, grammar::star_star, unsigned rhs)
+    {
+        auto result = 1u;
+        for (auto i = 0u; i != rhs % 8u; ++i)
+            result *= lhs;
+        return result;
+    }
+    unsigned operator()(grammar::expr, unsigned lhs, grammar::star, unsigned rhs)
+    {
+        return lhs * rhs;
+    }
+    unsigned operator()(grammar::expr, unsigned lhs, grammar::slash, unsigned rhs)
+    {
+        return rhs == 0 ? lhs : lhs / rhs;
+    }
+    unsigned operator()(grammar::expr, unsigned lhs, grammar::plus, unsigned rhs)
+    {
+        return lhs + rhs;
+    }
+    unsigned operator()(grammar::expr, unsigned lhs, grammar::minus, unsigned rhs)
+    {
+        return lhs - rhs;
+    }
+    unsigned operator()(grammar::expr, unsigned lhs, grammar::ampersand, unsigned rhs)
+    {
+        return lhs & rhs;
+    }
+    unsigned operator()(grammar::expr, unsigned lhs, grammar::pipe, unsigned rhs)
+    {
+        return lhs | rhs;
+    }
+
+    unsigned operator()(grammar::var_decl, lex::static_token<grammar::var, char> var,
+                        unsigned value)
+    {
+        variables[static_cast<unsigned char>(var.value())] = value;
+        return value;
+    }
+    unsigned operator()(grammar::decl, unsigned value)
+    {
+        return value;
+    }
+
+    unsigned operator()(grammar::decl_seq, unsigned value)
+    {
+        return value;
+    }
+    unsigned operator()(grammar::decl_seq, unsigned sum, unsigned value)
+    {
+        return sum + value;
+    }
+
+    template <class Error>
+    void operator()(Error, const lex::tokenizer<grammar::token_spec>&)
+    {
+        ++errors;
+    }
+};
+
+// the lines of the corpus and their number of tokens, which aren't part of the measurement
+struct calculator_lines
+{
+    std::vector<lex::token_spelling> lines;
+    std::vector<std::size_t>         tokens;
+
+    explicit calculator_lines(const std::string& corpus)
+    {
+        auto begin = corpus.data();
+        auto end   = begin + corpus.size();
+        while (begin != end)
+        {
+            auto line_end = std::find(begin, end, '\n');
+            lines.emplace_back(begin, static_cast<std::size_t>(line_end - begin));
+
+            lex::tokenizer<grammar::token_spec> tokenizer(begin, line_end);
+            auto                                count = std::size_t(0);
+            for (; !tokenizer.is_done(); tokenizer.bump())
+                ++count;
+            tokens.push_back(count);
+
+            begin = line_end == end ? end : line_end + 1;
+        }
+    }
+};
+
+// parses each line separately, like the REPL of the example
+void parse_calculator(const std::string& corpus, const calculator_lines& lines, measurement& m)
+{
+    calculator_visitor visitor;
+    std::size_t        checksum = 0;
+    for (auto i = std::size_t(0); i != lines.lines.size();)
+    {
+        auto begin = benchmark_clock::now();
+        auto count = std::size_t(0);
+        for (; count < batch_tokens && i != lines.lines.size(); ++i)
+        {
+            auto line   = lines.lines[i];
+            auto result = lex::parse<grammar::grammar>(line.data(), line.size(), visitor);
+            if (result.is_success())
+                checksum += result.value();
+            else
+                ++m.errors;
+            count += lines.tokens[i];
+        }
+        m.add_batch(begin, benchmark_clock::now(), count);
+    }
+    m.bytes += corpus.size();
+    m.errors += visitor.errors;
+    sink = checksum;
+}
+
+//=== reporting ===//
+std::string format_size(std::size_t size)
+{
+    if (size >= 1024u * 1024u * 1024u)
+        return std::to_string(size / (1024u * 1024u * 1024u)) + "GiB";
+    else if (size >= 1024u * 1024u)
+        return std::to_string(size / (1024u * 1024u)) + "MiB";
+    else
+        return std::to_string(size / 1024u) + "KiB";
+}
+
+void print_header()
+{
+    std::printf("| %-10s | %-6s | %10s | %10s | %8s | %8s | %8s | %8s | %10s |\n", "corpus", "size",
+                "MiB/s", "Mtokens/s", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "peak RSS");
+    std::printf("|------------|--------|-----------:|-----------:|---------:|---------:|---------:|"
+                "---------:|-----------:|\n");
+}
+
+// formats all columns of a row except for the peak RSS
+std::string format_row(const char* corpus, std::size_t size, measurement& m)
+{
+    if (m.errors != 0)
+        std::fprintf(stderr, "warning: %zu errors in the %s corpus\n", m.errors, corpus);
+
+    auto mib_per_s     = static_cast<double>(m.bytes) / (1024. * 1024.) / m.seconds;
+    auto mtokens_per_s = static_cast<double>(m.tokens) / 1e6 / m.seconds;
+
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer),
+                  "| %-10s | %-6s | %10.1f | %10.2f | %8.2f | %8.2f | %8.2f | %8.2f |", corpus,
+                  format_size(size).c_str(), mib_per_s, mtokens_per_s, m.percentile(0.5),
+                  m.percentile(0.9), m.percentile(0.99), m.percentile(0.999));
+    return buffer;
+}
+
+void print_row(const std::string& row, std::size_t peak_rss_kib)
+{
+    if (peak_rss_kib == 0)
+        std::printf("%s %10s |\n", row.c_str(), "n/a");
+    else
+        std::printf("%s %6zu MiB |\n", row.c_str(), peak_rss_kib / 1024u);
+    std::fflush(stdout);
+}
+
+// small inputs are measured repeatedly to get stable results
+constexpr double min_seconds = 0.5;
+
+template <class Func>
+measurement run(Func f)
+{
+    measurement m;
+    do
+        f(m);
+    while (m.seconds < min_seconds);
+    return m;
+}
+
+// generates the corpus and runs the benchmark by calling `f()`, which returns the measurement
+//
+// It is done in a child process, so the peak RSS of the row only includes that corpus and run,
+// not the ones before it.
+template <class Func>
+void run_row(const char* corpus, std::size_t size, Func f)
+{
+#if FOONATHAN_LEX_DETAIL_POSIX
+    int pipe_fds[2];
+    if (pipe(pipe_fds) == 0)
+    {
+        std::fflush(stdout);
+        auto pid = fork();
+        if (pid == 0)
+        {
+            close(pipe_fds[0]);
+            auto m   = f();
+            auto row = format_row(corpus, size, m);
+            auto ok  = write(pipe_fds[1], row.data(), row.size())
+                      == static_cast<ssize_t>(row.size());
+            _exit(ok ? 0 : 1);
+        }
+        close(pipe_fds[1]);
+
+        std::string row;
+        char        buffer[256];
+        ssize_t     n;
+        while ((n = read(pipe_fds[0], buffer, sizeof(buffer))) > 0)
+            row.append(buffer, static_cast<std::size_t>(n));
+        close(pipe_fds[0]);
+
+        int    status = 0;
+        rusage usage{};
+        auto   result = pid > 0 ? wait4(pid, &status, 0, &usage) : -1;
+        if (result == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+#    if defined(__APPLE__)
+            print_row(row, static_cast<std::size_t>(usage.ru_maxrss) / 1024u);
+#    else
+            print_row(row, static_cast<std::size_t>(usage.ru_maxrss));
+#    endif
+        }
+        else
+            std::fprintf(stderr, "error: benchmark of the %s corpus failed\n", corpus);
+        return;
+    }
+#endif
+
+    auto m = f();
+    print_row(format_row(corpus, size, m), 0);
+}
+
+// parses sizes like `32K`, `64M` or `1G`
+std::size_t parse_size(const char* str)
+{
+    char* end    = nullptr;
+    auto  result = static_cast<std::size_t>(std::strtoull(str, &end, 10));
+    switch (*end)
+    {
+    case 'G':
+    case 'g':
+        result *= 1024u;
+        // fallthrough
+    case 'M':
+    case 'm':
+        result *= 1024u;
+        // fallthrough
+    case 'K':
+    case 'k':
+        result *= 1024u;
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto max_size = argc > 1 ? parse_size(argv[1]) : std::size_t(1024u * 1024u * 1024u);
+
+    const std::size_t sizes[] = {1024u, 32u * 1024u, 1024u * 1024u, 32u * 1024u * 1024u,
+                                 1024u * 1024u * 1024u};
+
+    print_header();
+    for (auto size : sizes)
+    {
+        if (size > max_size)
+            break;
+
+        run_row("C", size, [&] {
+            auto corpus = c_corpus::generate(size);
+            return run([&](measurement& m) { tokenize_c(corpus, m); });
+        });
+        run_row("calculator", size, [&] {
+            auto corpus = calculator_corpus::generate(size);
+            auto lines  = calculator_lines(corpus);
+            return run([&](measurement& m) { parse_calculator(corpus, lines, m); });
+        });
+    }
+}
@@ -245,10 +245,12 @@ struct decl_seq : lex::list_production<decl_seq, grammar>
 };
 } // namespace grammar
 
-#include <cmath>
-#include <iostream>
-#include <string>
-#include <vector>
+#if !defined(FOONATHAN_LEX_EXAMPLE_NO_MAIN)
+
+#    include <cmath>
+#    include <iostream>
+#    include <string>
+#    include <vector>
 
 int main()
 {
@@ -471,3 +473,5 @@ int main()
         }
     }
 }
+
+#endif
@@ -4,8 +4,9 @@
 
 // This example implements an approximation of a tokenizer for C.
 
-#include <foonathan/lex/ascii.hpp>     // utilities for ASCII matching
-#include <foonathan/lex/tokenizer.hpp> // the main header for tokenization
+#include <foonathan/lex/ascii.hpp>       // utilities for ASCII matching
+#include <foonathan/lex/mapped_file.hpp> // memory mapping the input
+#include <foonathan/lex/tokenizer.hpp>   // the main header for tokenization
 
 // A namespace for the token grammar.
 namespace C
@@ -446,23 +447,41 @@ struct question_mark : FOONATHAN_LEX_LITERAL("?")
 {};
 } // namespace C
 
-#if !defined(FOONATHAN_LEX_TEST)
+#if defined(FOONATHAN_LEX_EXAMPLE_NO_MAIN)
+
+// Only the token specification is used, e.g. by the corpus benchmark.
+
+#elif !defined(FOONATHAN_LEX_TEST)
 
 // A simple driver program that tokenizes the standard input.
 
 #    include <iostream>
 #    include <string>
 
-int main()
+int main(int argc, char* argv[])
 {
     namespace lex = foonathan::lex;
 
-    // We need to read the input a string.
-    // This is required because the tokens are just string views into that string.
-    std::string input(std::istreambuf_iterator<char>{std::cin}, std::istreambuf_iterator<char>{});
+    // We need to have the entire input in memory,
+    // because the tokens are just string views into it.
+    // So either map the file given on the command line or read stdin into a string.
+    lex::mapped_file file;
+    std::string      input;
+    if (argc > 1)
+    {
+        file = lex::mapped_file(argv[1]);
+        if (!file)
+        {
+            std::cerr << "unable to open file '" << argv[1] << "'\n";
+            return 1;
+        }
+    }
+    else
+        input.assign(std::istreambuf_iterator<char>{std::cin}, std::istreambuf_iterator<char>{});
 
-    // Create a tokenizer for C passing it the string as input.
-    lex::tokenizer<C::spec> tokenizer(input.c_str(), input.size());
+    // Create a tokenizer for C passing it the input.
+    auto tokenizer = file ? lex::tokenizer<C::spec>(file.begin(), file.end())
+                          : lex::tokenizer<C::spec>(input.c_str(), input.size());
     // As long as we still have characters left.
     while (!tokenizer.is_done())
     {
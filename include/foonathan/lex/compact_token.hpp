@@ -0,0 +1,159 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_COMPACT_TOKEN_HPP_INCLUDED
+#define FOONATHAN_LEX_COMPACT_TOKEN_HPP_INCLUDED
+
+#include <climits>
+#include <cstdint>
+
+#include <foonathan/lex/tokenizer.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace compact_token_detail
+    {
+        template <class Token>
+        constexpr std::uint32_t literal_length(std::true_type /* literal */) noexcept
+        {
+            return sizeof(detail::literal_token_type<Token>::value) - 1;
+        }
+        template <class Token>
+        constexpr std::uint32_t literal_length(std::false_type /* literal */) noexcept
+        {
+            return 0;
+        }
+
+        // the length of the literal token with a given id, 0 if it isn't a literal token
+        template <class TokenList>
+        struct literal_length_table;
+
+        template <class... Tokens>
+        struct literal_length_table<detail::type_list<Tokens...>>
+        {
+            static constexpr std::uint32_t value[sizeof...(Tokens) + 2]
+                = {0, 0, literal_length<Tokens>(is_literal_token<Tokens>{})...};
+        };
+
+        template <class... Tokens>
+        constexpr std::uint32_t
+            literal_length_table<detail::type_list<Tokens...>>::value[sizeof...(Tokens) + 2];
+    } // namespace compact_token_detail
+
+    /// A single token in a compressed representation that only takes up 8 bytes.
+    ///
+    /// It stores a 32 bit offset from the beginning of the character range of the tokenizer
+    /// and packs the kind together with the length into another 32 bits.
+    /// The length of literal tokens is not stored at all, as it is known statically.
+    /// The spelling is recomputed when needed, which requires the tokenizer.
+    ///
+    /// \notes It is useful if lots of tokens have to be stored, use [lex::token]() otherwise.
+    template <class TokenSpec>
+    class compact_token
+    {
+        using id_type = token_kind_detail::id_type<TokenSpec>;
+        static_assert(sizeof(id_type) <= 2, "too many tokens for a compact token");
+
+        static constexpr auto kind_bits = sizeof(id_type) * CHAR_BIT;
+
+    public:
+        /// The maximal length of a non-literal token.
+        static constexpr std::size_t max_length = (std::uint32_t(1) << (32 - kind_bits)) - 1;
+
+        /// The maximal offset of a token.
+        static constexpr std::size_t max_offset = UINT32_MAX;
+
+        /// \effects Creates an invalid, partially-formed token that may not be used.
+        constexpr compact_token() noexcept : offset_(0), data_(0) {}
+
+        /// \effects Compresses the token that was created by the tokenizer.
+        /// \requires The offset of the token must not be bigger than `max_offset` and,
+        /// unless it is a literal token, its length must not be bigger than `max_length`.
+        explicit constexpr compact_token(const tokenizer<TokenSpec>& tokenizer,
+                                         const token<TokenSpec>&     token) noexcept
+        : offset_(0), data_(0)
+        {
+            auto offset = token.offset(tokenizer);
+            FOONATHAN_LEX_PRECONDITION(offset <= max_offset, "token offset too big");
+            offset_ = static_cast<std::uint32_t>(offset);
+
+            auto length = literal_length(token.kind().get()) != 0 ? 0u : token.spelling().size();
+            FOONATHAN_LEX_PRECONDITION(length <= max_length, "token too long");
+            data_ = static_cast<std::uint32_t>(length << kind_bits | token.kind().get());
+        }
+
+        /// \returns The kind of token it is.
+        constexpr token_kind<TokenSpec> kind() const noexcept
+        {
+            return token_kind<TokenSpec>::from_id(data_ & ((std::uint32_t(1) << kind_bits) - 1));
+        }
+
+        /// \returns `!!kind()`.
+        explicit constexpr operator bool() const noexcept
+        {
+            return !!kind();
+        }
+
+        /// \returns `kind().is(token)`.
+        template <class Token>
+        constexpr bool is(Token token = {}) const noexcept
+        {
+            return kind().is(token);
+        }
+
+        /// \returns `kind().is_category<Category>()`.
+        template <template <typename> class Category>
+        constexpr bool is_category() const noexcept
+        {
+            return kind().template is_category<Category>();
+        }
+
+        /// \returns `kind().name()`.
+        constexpr const char* name() const noexcept
+        {
+            return kind().name();
+        }
+
+        /// \returns The spelling of the token.
+        /// \requires `tokenizer` must be the tokenizer that created the token, or one of the same
+        /// character range.
+        constexpr token_spelling spelling(const tokenizer<TokenSpec>& tokenizer) const noexcept
+        {
+            return token_spelling(tokenizer.begin_ptr() + offset_, length());
+        }
+
+        /// \returns The offset of the token inside the character range of the tokenizer.
+        constexpr std::size_t offset() const noexcept
+        {
+            return offset_;
+        }
+
+        /// \returns The number of characters of the token.
+        constexpr std::size_t length() const noexcept
+        {
+            auto literal = literal_length(kind().get());
+            return literal != 0 ? literal : data_ >> kind_bits;
+        }
+
+    private:
+        static constexpr std::uint32_t literal_length(id_type id) noexcept
+        {
+            using table = compact_token_detail::literal_length_table<typename TokenSpec::list>;
+            return table::value[id];
+        }
+
+        std::uint32_t offset_;
+        std::uint32_t data_;
+    };
+
+    template <class TokenSpec>
+    constexpr std::size_t compact_token<TokenSpec>::max_length;
+    template <class TokenSpec>
+    constexpr std::size_t compact_token<TokenSpec>::max_offset;
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_COMPACT_TOKEN_HPP_INCLUDED
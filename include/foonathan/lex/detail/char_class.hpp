@@ -0,0 +1,339 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_DETAIL_CHAR_CLASS_HPP_INCLUDED
+#define FOONATHAN_LEX_DETAIL_CHAR_CLASS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+
+#ifndef FOONATHAN_LEX_ENABLE_SIMD
+#    define FOONATHAN_LEX_ENABLE_SIMD 1
+#endif
+
+#if defined(__has_builtin)
+#    if __has_builtin(__builtin_is_constant_evaluated)
+#        define FOONATHAN_LEX_DETAIL_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#    endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#    define FOONATHAN_LEX_DETAIL_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+// vectorized code can only be used if we can detect constant evaluation
+#if FOONATHAN_LEX_ENABLE_SIMD && defined(FOONATHAN_LEX_DETAIL_IS_CONSTANT_EVALUATED)
+#    if defined(__AVX2__)
+#        define FOONATHAN_LEX_DETAIL_SIMD_AVX2 1
+#        include <immintrin.h>
+#    elif defined(__SSSE3__)
+#        define FOONATHAN_LEX_DETAIL_SIMD_SSSE3 1
+#        include <tmmintrin.h>
+#    elif defined(__SSE2__)
+#        define FOONATHAN_LEX_DETAIL_SIMD_SSE2 1
+#        include <emmintrin.h>
+#    endif
+#endif
+
+#if defined(FOONATHAN_LEX_DETAIL_SIMD_AVX2) || defined(FOONATHAN_LEX_DETAIL_SIMD_SSSE3)
+// byte shuffles are available
+#    define FOONATHAN_LEX_DETAIL_SIMD_SHUFFLE 1
+#endif
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace detail
+    {
+        // a set of characters, computed from a predicate at compile-time
+        struct char_class
+        {
+            // if the class contains or excludes at most that many characters,
+            // they're matched vectorized
+            static constexpr std::size_t max_vector_chars = 8;
+
+            bool        contains[256];
+            char        chars[max_vector_chars];
+            std::size_t char_count;
+            // whether `chars` are the characters that are not in the class
+            bool chars_excluded;
+
+            // a character c is in the class if `low_nibbles[c & 0xF] & high_nibbles[c >> 4]`,
+            // which allows classifying many characters at once using byte shuffles
+            //
+            // Each distinct set of low nibbles that occurs together with some high nibble
+            // gets one bit, so this is only possible if there are at most eight of them.
+            unsigned char low_nibbles[16];
+            unsigned char high_nibbles[16];
+            bool          has_nibbles;
+
+            // the number of characters in `chars`
+            constexpr std::size_t vector_char_count() const noexcept
+            {
+                return chars_excluded ? 256u - char_count : char_count;
+            }
+
+            constexpr bool is_vectorizable() const noexcept
+            {
+                return vector_char_count() <= max_vector_chars;
+            }
+        };
+
+        constexpr void insert_char(char_class& cls, char c) noexcept
+        {
+            auto index = static_cast<unsigned char>(c);
+            if (cls.contains[index])
+                return;
+
+            cls.contains[index] = true;
+            if (cls.char_count < char_class::max_vector_chars)
+                cls.chars[cls.char_count] = c;
+            ++cls.char_count;
+        }
+
+        // computes the nibble tables once all characters are inserted
+        constexpr char_class& finish_char_class(char_class& cls) noexcept
+        {
+            // a class of almost all characters is matched by comparing with the others
+            cls.chars_excluded = cls.char_count > char_class::max_vector_chars
+                                 && 256u - cls.char_count <= char_class::max_vector_chars;
+            if (cls.chars_excluded)
+            {
+                auto count = 0u;
+                for (auto i = 0u; i != 256u; ++i)
+                    if (!cls.contains[i])
+                        cls.chars[count++] = static_cast<char>(static_cast<unsigned char>(i));
+            }
+
+            unsigned    bucket_low_nibbles[8] = {};
+            std::size_t bucket_count          = 0;
+
+            cls.has_nibbles = true;
+            for (auto high = 0u; high != 16u; ++high)
+            {
+                auto low_nibbles = 0u;
+                for (auto low = 0u; low != 16u; ++low)
+                    if (cls.contains[high * 16u + low])
+                        low_nibbles |= 1u << low;
+
+                cls.high_nibbles[high] = 0;
+                if (low_nibbles == 0u)
+                    continue;
+
+                auto bucket = std::size_t(0);
+                while (bucket != bucket_count && bucket_low_nibbles[bucket] != low_nibbles)
+                    ++bucket;
+                if (bucket == 8u)
+                {
+                    cls.has_nibbles = false;
+                    break;
+                }
+                else if (bucket == bucket_count)
+                    bucket_low_nibbles[bucket_count++] = low_nibbles;
+
+                cls.high_nibbles[high] = static_cast<unsigned char>(1u << bucket);
+            }
+
+            for (auto low = 0u; low != 16u; ++low)
+            {
+                auto bits = 0u;
+                for (auto bucket = 0u; bucket != bucket_count; ++bucket)
+                    if (bucket_low_nibbles[bucket] & (1u << low))
+                        bits |= 1u << bucket;
+                cls.low_nibbles[low] = static_cast<unsigned char>(bits);
+            }
+
+            return cls;
+        }
+
+        template <typename Predicate>
+        constexpr char_class make_char_class(Predicate predicate) noexcept
+        {
+            char_class result{};
+            for (auto i = 0u; i != 256u; ++i)
+            {
+                auto c = static_cast<char>(static_cast<unsigned char>(i));
+                if (predicate(c))
+                    insert_char(result, c);
+            }
+            return finish_char_class(result);
+        }
+
+        constexpr char_class make_char_class(char c) noexcept
+        {
+            char_class result{};
+            insert_char(result, c);
+            return finish_char_class(result);
+        }
+
+        constexpr char_class char_class_union(const char_class& lhs, const char_class& rhs) noexcept
+        {
+            auto result = lhs;
+            for (auto i = 0u; i != 256u; ++i)
+                if (rhs.contains[i])
+                    insert_char(result, static_cast<char>(static_cast<unsigned char>(i)));
+            return finish_char_class(result);
+        }
+
+        constexpr char_class char_class_complement(const char_class& cls) noexcept
+        {
+            char_class result{};
+            for (auto i = 0u; i != 256u; ++i)
+                if (!cls.contains[i])
+                    insert_char(result, static_cast<char>(static_cast<unsigned char>(i)));
+            return finish_char_class(result);
+        }
+
+#if defined(FOONATHAN_LEX_DETAIL_SIMD_AVX2)
+        inline const char* skip_char_class_vectorized(const char_class& cls, const char* cur,
+                                                      const char* end) noexcept
+        {
+            while (end - cur >= 32)
+            {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                auto match = _mm256_setzero_si256();
+                for (auto i = 0u; i != cls.vector_char_count(); ++i)
+                {
+                    auto chars = _mm256_set1_epi8(cls.chars[i]);
+                    match      = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, chars));
+                }
+
+                auto matched = static_cast<unsigned>(_mm256_movemask_epi8(match));
+                auto mask    = cls.chars_excluded ? matched : ~matched;
+                if (mask != 0)
+                    return cur + __builtin_ctz(mask);
+                cur += 32;
+            }
+            return cur;
+        }
+
+        inline const char* skip_char_class_shuffle(const char_class& cls, const char* cur,
+                                                   const char* end) noexcept
+        {
+            auto low_table  = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.low_nibbles)));
+            auto high_table = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.high_nibbles)));
+            auto nibble     = _mm256_set1_epi8(0x0F);
+
+            while (end - cur >= 32)
+            {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                auto low   = _mm256_and_si256(block, nibble);
+                auto high  = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble);
+                auto bits  = _mm256_and_si256(_mm256_shuffle_epi8(low_table, low),
+                                             _mm256_shuffle_epi8(high_table, high));
+
+                auto mask = static_cast<unsigned>(
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(bits, _mm256_setzero_si256())));
+                if (mask != 0)
+                    return cur + __builtin_ctz(mask);
+                cur += 32;
+            }
+            return cur;
+        }
+#elif defined(FOONATHAN_LEX_DETAIL_SIMD_SSSE3) || defined(FOONATHAN_LEX_DETAIL_SIMD_SSE2)
+        inline const char* skip_char_class_vectorized(const char_class& cls, const char* cur,
+                                                      const char* end) noexcept
+        {
+            while (end - cur >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                auto match = _mm_setzero_si128();
+                for (auto i = 0u; i != cls.vector_char_count(); ++i)
+                {
+                    auto chars = _mm_set1_epi8(cls.chars[i]);
+                    match      = _mm_or_si128(match, _mm_cmpeq_epi8(block, chars));
+                }
+
+                auto matched = static_cast<unsigned>(_mm_movemask_epi8(match));
+                auto mask    = (cls.chars_excluded ? matched : ~matched) & 0xFFFFu;
+                if (mask != 0)
+                    return cur + __builtin_ctz(mask);
+                cur += 16;
+            }
+            return cur;
+        }
+
+#    if defined(FOONATHAN_LEX_DETAIL_SIMD_SSSE3)
+        inline const char* skip_char_class_shuffle(const char_class& cls, const char* cur,
+                                                   const char* end) noexcept
+        {
+            auto low_table  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.low_nibbles));
+            auto high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.high_nibbles));
+            auto nibble     = _mm_set1_epi8(0x0F);
+
+            while (end - cur >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                auto low   = _mm_and_si128(block, nibble);
+                auto high  = _mm_and_si128(_mm_srli_epi16(block, 4), nibble);
+                auto bits  = _mm_and_si128(_mm_shuffle_epi8(low_table, low),
+                                          _mm_shuffle_epi8(high_table, high));
+
+                auto mask = static_cast<unsigned>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128())));
+                if (mask != 0)
+                    return cur + __builtin_ctz(mask);
+                cur += 16;
+            }
+            return cur;
+        }
+#    endif
+#endif
+
+        // returns a pointer to the first character not in the class
+        constexpr const char* skip_char_class(const char_class& cls, const char* cur,
+                                              const char* end) noexcept
+        {
+#if defined(FOONATHAN_LEX_DETAIL_SIMD_AVX2) || defined(FOONATHAN_LEX_DETAIL_SIMD_SSSE3)           \
+    || defined(FOONATHAN_LEX_DETAIL_SIMD_SSE2)
+            // most runs are short, only switch to vectorized code for long ones
+            auto scalar_end = end - cur > 16 ? cur + 16 : end;
+            while (cur != scalar_end && cls.contains[static_cast<unsigned char>(*cur)])
+                ++cur;
+
+            if (cur == scalar_end && !FOONATHAN_LEX_DETAIL_IS_CONSTANT_EVALUATED())
+            {
+#    if defined(FOONATHAN_LEX_DETAIL_SIMD_SHUFFLE)
+                // comparing with a few characters is cheaper than a shuffle
+                if (cls.has_nibbles && cls.vector_char_count() > 2u)
+                    cur = skip_char_class_shuffle(cls, cur, end);
+                else if (cls.is_vectorizable())
+                    cur = skip_char_class_vectorized(cls, cur, end);
+#    else
+                if (cls.is_vectorizable())
+                    cur = skip_char_class_vectorized(cls, cur, end);
+#    endif
+            }
+#endif
+
+            while (cur != end && cls.contains[static_cast<unsigned char>(*cur)])
+                ++cur;
+            return cur;
+        }
+
+        // returns a pointer to the first occurrence of the character, or end
+        constexpr const char* find_char(const char* cur, const char* end, char c) noexcept
+        {
+#if defined(FOONATHAN_LEX_DETAIL_IS_CONSTANT_EVALUATED)
+            if (!FOONATHAN_LEX_DETAIL_IS_CONSTANT_EVALUATED())
+            {
+                if (cur == end)
+                    return end;
+
+                auto result = std::memchr(cur, static_cast<unsigned char>(c),
+                                          static_cast<std::size_t>(end - cur));
+                return result ? static_cast<const char*>(result) : end;
+            }
+#endif
+
+            while (cur != end && *cur != c)
+                ++cur;
+            return cur;
+        }
+    } // namespace detail
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_DETAIL_CHAR_CLASS_HPP_INCLUDED
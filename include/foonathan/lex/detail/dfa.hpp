@@ -0,0 +1,301 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_DETAIL_DFA_HPP_INCLUDED
+#define FOONATHAN_LEX_DETAIL_DFA_HPP_INCLUDED
+
+#include <foonathan/lex/detail/select_integer.hpp>
+#include <foonathan/lex/detail/tracked_end.hpp>
+#include <foonathan/lex/detail/type_list.hpp>
+#include <foonathan/lex/match_result.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace detail
+    {
+        // compile-time properties of a trie (see detail/trie.hpp)
+        template <class TokenSpec, class Root>
+        struct dfa_trie_info
+        {
+            template <class Node>
+            static constexpr std::size_t node_count() noexcept
+            {
+                return 1 + children_count(typename Node::children{});
+            }
+            template <class... Children>
+            static constexpr std::size_t children_count(type_list<Children...>) noexcept
+            {
+                std::size_t result  = 0;
+                bool        dummy[] = {(result += node_count<Children>(), true)..., true};
+                (void)dummy;
+                return result;
+            }
+
+            template <class Node>
+            static constexpr std::size_t max_depth() noexcept
+            {
+                return children_depth(typename Node::children{});
+            }
+            template <class... Children>
+            static constexpr std::size_t children_depth(type_list<Children...>) noexcept
+            {
+                std::size_t result  = 0;
+                bool        dummy[] = {
+                    (result < 1 + max_depth<Children>() && (result = 1 + max_depth<Children>()),
+                     true)...,
+                    true};
+                (void)dummy;
+                return result;
+            }
+
+            template <class Node>
+            static constexpr void mark_characters(bool (&used)[256]) noexcept
+            {
+                mark_children_characters(used, typename Node::children{});
+            }
+            template <class... Children>
+            static constexpr void mark_children_characters(bool (&used)[256],
+                                                           type_list<Children...>) noexcept
+            {
+                bool dummy[] = {(used[static_cast<unsigned char>(Children::character)] = true,
+                                 mark_characters<Children>(used), true)...,
+                                true};
+                (void)dummy;
+            }
+
+            static constexpr std::size_t class_count() noexcept
+            {
+                bool used[256] = {};
+                mark_characters<Root>(used);
+
+                std::size_t result = 1;
+                for (auto u : used)
+                    if (u)
+                        ++result;
+                return result;
+            }
+
+            using rule_fn = match_result<TokenSpec> (*)(const char*, const char*);
+
+            //=== rules ===//
+            template <class... Rules>
+            static constexpr match_result<TokenSpec> try_match_rules(const char* str,
+                                                                     const char* end) noexcept
+            {
+                auto result = match_result<TokenSpec>::unmatched();
+                bool dummy[]
+                    = {(result.is_unmatched() && (result = Rules::try_match(str, end), true))...,
+                       true};
+                (void)dummy;
+                return result;
+            }
+
+            static constexpr rule_fn get_rules(type_list<>) noexcept
+            {
+                return nullptr;
+            }
+            template <class... Rules>
+            static constexpr rule_fn get_rules(type_list<Rules...>) noexcept
+            {
+                return &try_match_rules<Rules...>;
+            }
+
+            template <class... Rules>
+            static constexpr match_result<TokenSpec> try_match_rules(type_list<Rules...>,
+                                                                     const char* str,
+                                                                     const char* end) noexcept
+            {
+                return try_match_rules<Rules...>(str, end);
+            }
+        };
+
+        // flattens a trie into a state transition table
+        //
+        // Every node of the trie becomes a state, the root is state 0.
+        // Characters that occur in some literal are mapped to their own character class,
+        // all other characters share class 0, which never has a transition.
+        template <class TokenSpec, class Root>
+        struct dfa_builder
+        {
+            using info = dfa_trie_info<TokenSpec, Root>;
+
+            static constexpr auto state_count = info::template node_count<Root>();
+            static constexpr auto class_count = info::class_count();
+            static constexpr auto depth       = info::template max_depth<Root>();
+
+            //=== table ===//
+            using state_type = select_integer<state_count>;
+            using class_type = select_integer<class_count>;
+            using id_type    = token_kind_detail::id_type<TokenSpec>;
+            using rule_fn    = typename info::rule_fn;
+
+            struct table
+            {
+                class_type char_class[256];
+                // 0 means no transition, as no node has the root as child
+                state_type transition[state_count][class_count];
+                // 0 for non-terminal states, the token id otherwise
+                id_type accept[state_count];
+                // the conflicting rules of terminal states
+                rule_fn rules[state_count];
+            };
+
+            //=== table construction ===//
+            template <class Node>
+            static constexpr id_type get_accept(std::true_type /* terminal */) noexcept
+            {
+                return Node::id;
+            }
+            template <class Node>
+            static constexpr id_type get_accept(std::false_type /* terminal */) noexcept
+            {
+                return 0;
+            }
+
+            template <class Node>
+            static constexpr void fill_state(table& result, std::size_t state) noexcept
+            {
+                using is_terminal = std::integral_constant<bool, Node::is_terminal>;
+
+                result.accept[state] = get_accept<Node>(is_terminal{});
+                result.rules[state]  = is_terminal::value ? info::get_rules(typename Node::rules{})
+                                                         : nullptr;
+                fill_children(result, state, state + 1, typename Node::children{});
+            }
+
+            static constexpr void fill_children(table&, std::size_t, std::size_t,
+                                                type_list<>) noexcept
+            {}
+            template <class... Children>
+            static constexpr void fill_children(table& result, std::size_t parent,
+                                                std::size_t next, type_list<Children...>) noexcept
+            {
+                // children are numbered in pre-order, so each child's state follows the states of
+                // all previous siblings' subtrees
+                bool dummy[]
+                    = {(fill_child<Children>(result, parent, next),
+                        next += info::template node_count<Children>(), true)...,
+                       true};
+                (void)dummy;
+            }
+
+            template <class Child>
+            static constexpr void fill_child(table& result, std::size_t parent,
+                                             std::size_t state) noexcept
+            {
+                auto char_class = result.char_class[static_cast<unsigned char>(Child::character)];
+                result.transition[parent][char_class] = static_cast<state_type>(state);
+                fill_state<Child>(result, state);
+            }
+
+            static constexpr table build() noexcept
+            {
+                table result{};
+
+                bool used[256] = {};
+                info::template mark_characters<Root>(used);
+                std::size_t next_class = 1;
+                for (auto c = 0u; c != 256u; ++c)
+                    if (used[c])
+                        result.char_class[c] = static_cast<class_type>(next_class++);
+
+                fill_state<Root>(result, 0);
+                return result;
+            }
+        };
+
+        // matches the literal tokens of a trie by a loop over the transition table of the
+        // equivalent DFA
+        //
+        // It gives the same result as `Root::try_match()`.
+        template <class TokenSpec, class Root>
+        class dfa
+        {
+            using builder = dfa_builder<TokenSpec, Root>;
+
+            static constexpr typename builder::table table_ = builder::build();
+
+        public:
+            static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                               const char* end) noexcept
+            {
+                if (str == end)
+                    return match_result<TokenSpec>::eof();
+
+                // walk the literals as long as possible, remembering the states
+                typename builder::state_type path[builder::depth + 1] = {};
+                std::size_t                  length                   = 0;
+
+                auto cur   = str;
+                auto state = typename builder::state_type(0);
+                while (cur != end)
+                {
+                    auto char_class = table_.char_class[static_cast<unsigned char>(*cur)];
+                    auto next       = table_.transition[state][char_class];
+                    if (next == 0)
+                        break;
+
+                    path[length++] = next;
+                    state          = next;
+                    ++cur;
+                }
+
+                // go back until we find a terminal state,
+                // where the conflicting rules or the literal match
+                auto result = cur == end ? match_result<TokenSpec>::eof()
+                                         : match_result<TokenSpec>::unmatched();
+                for (; length > 0; --length)
+                {
+                    auto cur_state = path[length - 1];
+                    if (table_.accept[cur_state] == 0)
+                        continue;
+
+                    auto rule_result = table_.rules[cur_state]
+                                           ? table_.rules[cur_state](str, end)
+                                           : match_result<TokenSpec>::unmatched();
+                    if (rule_result.is_success())
+                        return rule_result;
+                    else if (rule_result.is_error())
+                        // a shorter literal might still match
+                        result = rule_result;
+                    else
+                        return match_result<TokenSpec>::success(token_kind<TokenSpec>::from_id(
+                                                                    table_.accept[cur_state]),
+                                                                length);
+                }
+                if (result.is_matched())
+                    return result;
+
+                // now match all rules
+                auto rule_result = builder::info::try_match_rules(typename Root::rules{}, str, end);
+                if (rule_result.is_matched())
+                    return rule_result;
+
+                // nothing matched, error
+                return match_result<TokenSpec>::error(1);
+            }
+
+            static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                               std::size_t size) noexcept
+            {
+                return try_match(str, str + size);
+            }
+
+            // the table can't track how far the rules look, but the trie can
+            static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                               const tracked_end& end) noexcept
+            {
+                return Root::try_match(str, end);
+            }
+        };
+
+        template <class TokenSpec, class Root>
+        constexpr typename dfa_builder<TokenSpec, Root>::table dfa<TokenSpec, Root>::table_;
+    } // namespace detail
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_DETAIL_DFA_HPP_INCLUDED
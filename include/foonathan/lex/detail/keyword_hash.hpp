@@ -0,0 +1,247 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_DETAIL_KEYWORD_HASH_HPP_INCLUDED
+#define FOONATHAN_LEX_DETAIL_KEYWORD_HASH_HPP_INCLUDED
+
+#include <cstdint>
+
+#include <foonathan/lex/detail/type_list.hpp>
+#include <foonathan/lex/literal_token.hpp>
+#include <foonathan/lex/match_result.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace detail
+    {
+        // the key of a string is its length, first and last character
+        constexpr std::size_t keyword_key(std::size_t length, char first, char last) noexcept
+        {
+            return (length & 0xFFu) | std::size_t(static_cast<unsigned char>(first)) << 8
+                   | std::size_t(static_cast<unsigned char>(last)) << 16;
+        }
+
+        constexpr std::size_t keyword_hash(std::uint_least32_t seed, std::size_t bits,
+                                           std::size_t key) noexcept
+        {
+            auto product = (key * seed) & 0xFFFFFFFFu;
+            return product >> (32 - bits);
+        }
+
+        // hashes a string by its length, first and last character
+        constexpr std::size_t keyword_hash(std::uint_least32_t seed, std::size_t bits,
+                                           std::size_t length, char first, char last) noexcept
+        {
+            return keyword_hash(seed, bits, keyword_key(length, first, last));
+        }
+
+        constexpr std::size_t keyword_hash_bits(std::size_t count) noexcept
+        {
+            // at least twice as many buckets as keywords
+            std::size_t result = 1;
+            while ((std::size_t(1) << result) < 2 * count)
+                ++result;
+            return result;
+        }
+
+        template <class TokenSpec, class Keywords>
+        struct keyword_list;
+
+        template <class TokenSpec, class... Keywords>
+        struct keyword_list<TokenSpec, type_list<Keywords...>>
+        {
+            using id_type = token_kind_detail::id_type<TokenSpec>;
+
+            static constexpr std::size_t count        = sizeof...(Keywords);
+            static constexpr std::size_t bits         = keyword_hash_bits(count);
+            static constexpr std::size_t bucket_count = std::size_t(1) << bits;
+
+            static constexpr const char* strings[count] = {literal_token_type<Keywords>::value...};
+            static constexpr std::size_t lengths[count]
+                = {sizeof(literal_token_type<Keywords>::value) - 1 ...};
+            static constexpr id_type ids[count] = {token_kind<TokenSpec>(Keywords{}).get()...};
+        };
+
+        template <class TokenSpec, class... Keywords>
+        constexpr const char* keyword_list<TokenSpec, type_list<Keywords...>>::strings[];
+        template <class TokenSpec, class... Keywords>
+        constexpr std::size_t keyword_list<TokenSpec, type_list<Keywords...>>::lengths[];
+        template <class TokenSpec, class... Keywords>
+        constexpr typename keyword_list<TokenSpec, type_list<Keywords...>>::id_type
+            keyword_list<TokenSpec, type_list<Keywords...>>::ids[];
+
+        // computes the layout of the hash table
+        //
+        // The hash function is chosen from a family of multiplicative hash functions, so that it is
+        // perfect if possible, i.e. each bucket contains at most one keyword.
+        template <class List>
+        struct keyword_hash_builder
+        {
+            static constexpr auto count        = List::count;
+            static constexpr auto bucket_count = List::bucket_count;
+
+            static constexpr std::size_t bucket_of(std::uint_least32_t seed,
+                                                   std::size_t         keyword) noexcept
+            {
+                return keyword_hash(seed, List::bits, List::lengths[keyword],
+                                    List::strings[keyword][0],
+                                    List::strings[keyword][List::lengths[keyword] - 1]);
+            }
+
+            struct table
+            {
+                std::uint_least32_t seed;
+                std::size_t         min_length, max_length;
+                // whether a keyword starts with the character
+                bool first[256];
+                // the keywords of bucket i are entries[bucket_begin[i]] to
+                // entries[bucket_begin[i + 1]]
+                std::size_t bucket_begin[bucket_count + 1];
+                std::size_t entries[count];
+            };
+
+            static constexpr std::size_t max_bucket_size(std::uint_least32_t seed,
+                                                         const std::size_t (&keys)[count]) noexcept
+            {
+                std::size_t sizes[bucket_count] = {};
+                std::size_t result              = 0;
+                for (auto i = 0u; i != count; ++i)
+                {
+                    auto& size = sizes[keyword_hash(seed, List::bits, keys[i])];
+                    if (++size > result)
+                        result = size;
+                }
+                return result;
+            }
+
+            static constexpr std::uint_least32_t find_seed() noexcept
+            {
+                // the keys don't depend on the seed, so compute them once
+                std::size_t keys[count] = {};
+                for (auto i = 0u; i != count; ++i)
+                    keys[i] = keyword_key(List::lengths[i], List::strings[i][0],
+                                          List::strings[i][List::lengths[i] - 1]);
+
+                std::uint_least32_t best_seed = 0;
+                std::size_t         best_size = count + 1;
+                for (auto i = 0u; i != 256u && best_size > 1; ++i)
+                {
+                    // odd multipliers around the golden ratio
+                    auto seed = static_cast<std::uint_least32_t>(0x9E3779B1u + 2u * i);
+                    auto size = max_bucket_size(seed, keys);
+                    if (size < best_size)
+                    {
+                        best_seed = seed;
+                        best_size = size;
+                    }
+                }
+                return best_seed;
+            }
+
+            static constexpr table build() noexcept
+            {
+                table result{};
+                result.seed       = find_seed();
+                result.min_length = List::lengths[0];
+                result.max_length = List::lengths[0];
+                for (auto i = 0u; i != count; ++i)
+                {
+                    if (List::lengths[i] < result.min_length)
+                        result.min_length = List::lengths[i];
+                    if (List::lengths[i] > result.max_length)
+                        result.max_length = List::lengths[i];
+                    result.first[static_cast<unsigned char>(List::strings[i][0])] = true;
+
+                    ++result.bucket_begin[bucket_of(result.seed, i) + 1];
+                }
+
+                for (auto i = 0u; i != bucket_count; ++i)
+                    result.bucket_begin[i + 1] += result.bucket_begin[i];
+
+                std::size_t next[bucket_count] = {};
+                for (auto i = 0u; i != count; ++i)
+                {
+                    auto bucket = bucket_of(result.seed, i);
+                    result.entries[result.bucket_begin[bucket] + next[bucket]++] = i;
+                }
+
+                return result;
+            }
+        };
+
+        // matches keywords using a hash table
+        //
+        // Identifiers that are shorter or longer than all keywords or start with a character no
+        // keyword starts with are rejected immediately,
+        // otherwise only the keywords of a single bucket have to be compared.
+        template <class TokenSpec, class Keywords>
+        class keyword_hash_table
+        {
+            using list    = keyword_list<TokenSpec, Keywords>;
+            using builder = keyword_hash_builder<list>;
+
+            static constexpr typename builder::table table_ = builder::build();
+
+        public:
+            // whether the identifier can be a keyword, only checks the length and first character
+            static constexpr bool is_candidate(const char* str, std::size_t length) noexcept
+            {
+                return length >= table_.min_length && length <= table_.max_length
+                       && table_.first[static_cast<unsigned char>(str[0])];
+            }
+
+            // matches a keyword that is exactly the given identifier
+            static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                               std::size_t length) noexcept
+            {
+                if (!is_candidate(str, length))
+                    return match_result<TokenSpec>::unmatched();
+
+                auto bucket
+                    = keyword_hash(table_.seed, list::bits, length, str[0], str[length - 1]);
+                for (auto i = table_.bucket_begin[bucket]; i != table_.bucket_begin[bucket + 1];
+                     ++i)
+                {
+                    auto keyword = table_.entries[i];
+                    if (list::lengths[keyword] != length)
+                        continue;
+
+                    auto equal = true;
+                    for (auto j = 0u; j != length && equal; ++j)
+                        equal = list::strings[keyword][j] == str[j];
+                    if (equal)
+                        return match_result<TokenSpec>::success(token_kind<TokenSpec>::from_id(
+                                                                    list::ids[keyword]),
+                                                                length);
+                }
+
+                return match_result<TokenSpec>::unmatched();
+            }
+        };
+
+        template <class TokenSpec, class Keywords>
+        constexpr typename keyword_hash_table<TokenSpec, Keywords>::builder::table
+            keyword_hash_table<TokenSpec, Keywords>::table_;
+
+        template <class TokenSpec>
+        class keyword_hash_table<TokenSpec, type_list<>>
+        {
+        public:
+            static constexpr bool is_candidate(const char*, std::size_t) noexcept
+            {
+                return false;
+            }
+
+            static constexpr match_result<TokenSpec> try_match(const char*, std::size_t) noexcept
+            {
+                return match_result<TokenSpec>::unmatched();
+            }
+        };
+    } // namespace detail
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_DETAIL_KEYWORD_HASH_HPP_INCLUDED
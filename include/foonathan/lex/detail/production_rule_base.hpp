@@ -43,27 +43,22 @@ namespace lex
             struct any_token
             {};
 
+            // the number of token ids, which is also used as the id of any_token
             template <class TokenSpec>
-            constexpr bool peek_token_is(lex::detail::type_list<>, const tokenizer<TokenSpec>&)
+            constexpr std::size_t token_id_count() noexcept
             {
-                return false;
+                return TokenSpec::size + 2;
             }
 
-            template <class Head, class... Tail, class TokenSpec>
-            constexpr bool peek_token_is(lex::detail::type_list<Head, Tail...>,
-                                         const tokenizer<TokenSpec>& tokenizer)
+            template <class TokenSpec, class Token>
+            constexpr std::size_t leading_token_id(Token) noexcept
             {
-                if (tokenizer.peek().is(Head{}))
-                    return true;
-                else
-                    return peek_token_is(lex::detail::type_list<Tail...>{}, tokenizer);
+                return token_kind_detail::get_id<TokenSpec, Token>();
             }
-
-            template <class... Tail, class TokenSpec>
-            constexpr bool peek_token_is(lex::detail::type_list<any_token, Tail...>,
-                                         const tokenizer<TokenSpec>&)
+            template <class TokenSpec>
+            constexpr std::size_t leading_token_id(any_token) noexcept
             {
-                return true;
+                return token_id_count<TokenSpec>();
             }
 
             //=== parser implementations ===//
@@ -6,6 +6,7 @@
 #define FOONATHAN_LEX_PRODUCTION_RULE_PRODUCTION_HPP_INCLUDED
 
 #include <foonathan/lex/detail/production_rule_base.hpp>
+#include <foonathan/lex/detail/production_rule_token.hpp>
 #include <foonathan/lex/parse_error.hpp>
 
 namespace foonathan
@@ -176,12 +177,53 @@ namespace lex
                 using parser = parser_for<Rules..., Cont>;
             };
 
+            //=== FIRST sets ===//
+            // the tokens a rule can start with, any_token if they are unknown
+            template <class Rule, typename = void>
+            struct first_set
+            {
+                using type = lex::detail::type_list<any_token>;
+            };
+            template <class Rule>
+            struct first_set<Rule, std::enable_if_t<is_token_rule<Rule>::value>>
+            {
+                using type = typename Rule::leading_tokens;
+            };
+            template <class Head, class... Tail>
+            struct first_set<sequence<Head, Tail...>>
+            {
+                using type = typename first_set<Head>::type;
+            };
+
+            // whether the rule matches exactly one token, i.e. matches iff the next token is in its
+            // FIRST set
+            template <class Rule>
+            struct is_single_token_rule : std::false_type
+            {};
+            template <class Token>
+            struct is_single_token_rule<token<Token>> : std::true_type
+            {};
+            template <class Token>
+            struct is_single_token_rule<silent_token<Token>> : std::true_type
+            {};
+            template <class Rule>
+            struct is_single_token_rule<token_sequence<Rule>> : is_single_token_rule<Rule>
+            {};
+            template <class... Choices>
+            struct is_single_token_rule<token_choice<Choices...>>
+            : lex::detail::all_of<lex::detail::type_list<Choices...>, is_single_token_rule>
+            {};
+
             template <class PeekRule, class Rule>
             struct choice_alternative : base_choice_rule
             {
                 using peek_rule = PeekRule;
                 using rule      = Rule;
 
+                using leading_tokens = typename first_set<PeekRule>::type;
+                // if true, the alternative is taken iff the next token is a leading token
+                using is_decisive = is_single_token_rule<PeekRule>;
+
                 template <class TokenSpec>
                 static constexpr bool peek(tokenizer<TokenSpec> tokenizer)
                 {
@@ -193,6 +235,63 @@ namespace lex
                 using parser = parser_for<Rule, Cont>;
             };
 
+            // for each token, the alternatives of a choice that can start with it
+            template <class TokenSpec, class... Choices>
+            struct choice_dispatch
+            {
+                static constexpr std::size_t token_count = token_id_count<TokenSpec>();
+
+                struct table
+                {
+                    // alternative i can only be taken if may_start[id][i]
+                    bool may_start[token_count][sizeof...(Choices)];
+                };
+
+                static constexpr void insert(table& result, std::size_t alternative,
+                                             std::size_t id) noexcept
+                {
+                    if (id == token_count)
+                    {
+                        for (auto i = 0u; i != token_count; ++i)
+                            result.may_start[i][alternative] = true;
+                    }
+                    else
+                        result.may_start[id][alternative] = true;
+                }
+
+                template <class... Tokens>
+                static constexpr bool insert(table& result, std::size_t alternative,
+                                             lex::detail::type_list<Tokens...>) noexcept
+                {
+                    bool dummy[]
+                        = {(insert(result, alternative, leading_token_id<TokenSpec>(Tokens{})),
+                            true)...,
+                           true};
+                    (void)dummy;
+                    return true;
+                }
+
+                static constexpr table build() noexcept
+                {
+                    table       result{};
+                    std::size_t alternative = 0;
+                    bool        dummy[]
+                        = {insert(result, alternative++, typename Choices::leading_tokens{})...,
+                           true};
+                    (void)dummy;
+                    return result;
+                }
+
+                static constexpr table value = build();
+            };
+
+            template <class TokenSpec, class... Choices>
+            constexpr typename choice_dispatch<TokenSpec, Choices...>::table
+                choice_dispatch<TokenSpec, Choices...>::value;
+
+            // Looks up the alternatives that can start with the next token in a table.
+            // Only those are considered, and the peek rule is only evaluated if it can't be
+            // decided by the token alone.
             template <class... Choices>
             struct choice : base_choice_rule
             {
@@ -206,22 +305,24 @@ namespace lex
                     using grammar = typename Cont::grammar;
                     using tlp     = typename Cont::tlp;
 
-                    template <class R, class TokenSpec, typename Func>
-                    static constexpr R parse_impl(choice<>, tokenizer<TokenSpec>& tokenizer,
-                                                  Func& f)
+                    template <class R, std::size_t I, class TokenSpec, typename Func>
+                    static constexpr R parse_impl(choice<>, const bool*,
+                                                  tokenizer<TokenSpec>& tokenizer, Func& f)
                     {
                         auto error = exhausted_choice<grammar, tlp>(tlp{});
                         lex::detail::report_error(f, error, tokenizer);
                         return {};
                     }
-                    template <class R, class Head, class... Tail, class TokenSpec, typename Func>
-                    static constexpr R parse_impl(choice<Head, Tail...>,
+                    template <class R, std::size_t I, class Head, class... Tail, class TokenSpec,
+                              typename Func>
+                    static constexpr R parse_impl(choice<Head, Tail...>, const bool* may_start,
                                                   tokenizer<TokenSpec>& tokenizer, Func& f)
                     {
-                        if (Head::peek(tokenizer))
+                        if (may_start[I] && (Head::is_decisive::value || Head::peek(tokenizer)))
                             return parser_for<Head, Cont>::parse(tokenizer, f);
                         else
-                            return parse_impl<R>(choice<Tail...>{}, tokenizer, f);
+                            return parse_impl<R, I + 1>(choice<Tail...>{}, may_start, tokenizer,
+                                                        f);
                     }
 
                     template <class TokenSpec, typename Func>
@@ -229,7 +330,12 @@ namespace lex
                     {
                         using return_type = std::common_type_t<decltype(
                             parser_for<Choices, Cont>::parse(tokenizer, f))...>;
-                        return parse_impl<return_type>(choice<Choices...>{}, tokenizer, f);
+                        using dispatch    = choice_dispatch<TokenSpec, Choices...>;
+
+                        auto id = tokenizer.peek().kind().get();
+                        return parse_impl<return_type, 0>(choice<Choices...>{},
+                                                          dispatch::value.may_start[id], tokenizer,
+                                                          f);
                     }
                 };
             };
@@ -6,6 +6,7 @@
 #define FOONATHAN_LEX_PRODUCTION_RULE_TOKEN_HPP_INCLUDED
 
 #include <foonathan/lex/detail/production_rule_base.hpp>
+#include <foonathan/lex/detail/select_integer.hpp>
 #include <foonathan/lex/parser.hpp>
 
 namespace foonathan
@@ -189,6 +190,70 @@ namespace lex
                 using parser = parser_for<Head, Tail..., Cont>;
             };
 
+            // for each token, the alternative of a token choice that starts with it
+            template <class TokenSpec, class... Choices>
+            struct token_choice_dispatch
+            {
+                static constexpr std::size_t token_count    = token_id_count<TokenSpec>();
+                static constexpr std::size_t no_alternative = sizeof...(Choices);
+
+                using index_type = lex::detail::select_integer<no_alternative>;
+
+                struct table
+                {
+                    // the first alternative that starts with the token, or no_alternative
+                    index_type alternative[token_count];
+                };
+
+                static constexpr void insert(table& result, std::size_t alternative,
+                                             std::size_t id) noexcept
+                {
+                    if (id == token_count)
+                    {
+                        // a catch-all takes every token not handled by a previous alternative
+                        for (auto i = 0u; i != token_count; ++i)
+                            if (result.alternative[i] == no_alternative)
+                                result.alternative[i] = static_cast<index_type>(alternative);
+                    }
+                    else if (result.alternative[id] == no_alternative)
+                        result.alternative[id] = static_cast<index_type>(alternative);
+                }
+
+                template <class... Tokens>
+                static constexpr bool insert(table& result, std::size_t alternative,
+                                             lex::detail::type_list<Tokens...>) noexcept
+                {
+                    bool dummy[]
+                        = {(insert(result, alternative, leading_token_id<TokenSpec>(Tokens{})),
+                            true)...,
+                           true};
+                    (void)dummy;
+                    return true;
+                }
+
+                static constexpr table build() noexcept
+                {
+                    table result{};
+                    for (auto i = 0u; i != token_count; ++i)
+                        result.alternative[i] = static_cast<index_type>(no_alternative);
+
+                    std::size_t alternative = 0;
+                    bool        dummy[]
+                        = {insert(result, alternative++, typename Choices::leading_tokens{})...,
+                           true};
+                    (void)dummy;
+                    return result;
+                }
+
+                static constexpr table value = build();
+            };
+
+            template <class TokenSpec, class... Choices>
+            constexpr typename token_choice_dispatch<TokenSpec, Choices...>::table
+                token_choice_dispatch<TokenSpec, Choices...>::value;
+
+            // As the leading tokens are unique, the alternative is looked up in a table indexed by
+            // the id of the next token, and its parser is called through a table of functions.
             template <class... Choices>
             struct token_choice : base_token_rule
             {
@@ -244,9 +309,17 @@ namespace lex
                         lex::detail::report_error(f, error, tokenizer);
                     }
 
+                    template <class R, class Choice, class TokenSpec, typename Func,
+                              typename... Args>
+                    static constexpr R parse_alternative(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                                         Args&&... args)
+                    {
+                        return parser_for<Choice, Cont>::parse_known(tokenizer, f,
+                                                                     static_cast<Args&&>(args)...);
+                    }
                     template <class R, class TokenSpec, typename Func, typename... Args>
-                    static constexpr R parse_impl(token_choice<>, tokenizer<TokenSpec>& tokenizer,
-                                                  Func& f, Args&&...)
+                    static constexpr R parse_no_alternative(tokenizer<TokenSpec>& tokenizer,
+                                                            Func& f, Args&&...)
                     {
                         // need to remove the tag any_token, as it is not part of the token spec
                         report_error(has_catch_all{},
@@ -254,20 +327,6 @@ namespace lex
                                      f);
                         return {};
                     }
-                    template <class R, class Head, class... Tail, class TokenSpec, typename Func,
-                              typename... Args>
-                    static constexpr R parse_impl(token_choice<Head, Tail...>,
-                                                  tokenizer<TokenSpec>& tokenizer, Func& f,
-                                                  Args&&... args)
-                    {
-                        if (peek_token_is(typename Head::leading_tokens{}, tokenizer))
-                            return parser_for<Head, Cont>::parse_known(tokenizer, f,
-                                                                       static_cast<Args&&>(
-                                                                           args)...);
-                        else
-                            return parse_impl<R>(token_choice<Tail...>{}, tokenizer, f,
-                                                 static_cast<Args&&>(args)...);
-                    }
 
                     template <class TokenSpec, typename Func, typename... Args>
                     static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f,
@@ -276,8 +335,20 @@ namespace lex
                         using return_type = std::common_type_t<decltype(
                             parser_for<Choices, Cont>::parse(tokenizer, f,
                                                              static_cast<Args&&>(args)...))...>;
-                        return parse_impl<return_type>(token_choice<Choices...>{}, tokenizer, f,
-                                                       static_cast<Args&&>(args)...);
+                        using dispatch    = token_choice_dispatch<TokenSpec, Choices...>;
+
+                        using parse_fn
+                            = return_type (*)(lex::tokenizer<TokenSpec>&, Func&, Args&&...);
+
+                        // indexed by the alternative, no_alternative is the last one
+                        const parse_fn alternatives[]
+                            = {&parse_alternative<return_type, Choices, TokenSpec, Func,
+                                                  Args...>...,
+                               &parse_no_alternative<return_type, TokenSpec, Func, Args...>};
+
+                        auto id = tokenizer.peek().kind().get();
+                        return alternatives[dispatch::value.alternative[id]](
+                            tokenizer, f, static_cast<Args&&>(args)...);
                     }
                 };
             };
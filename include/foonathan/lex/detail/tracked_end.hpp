@@ -0,0 +1,123 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_DETAIL_TRACKED_END_HPP_INCLUDED
+#define FOONATHAN_LEX_DETAIL_TRACKED_END_HPP_INCLUDED
+
+#include <type_traits>
+#include <utility>
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace detail
+    {
+        // the end of the input, remembering the furthest position matching has looked at
+        //
+        // The matching functions are templates on the type of the end pointer,
+        // so they can be given a tracked_end instead of a `const char*`.
+        // Every comparison of a position with the end counts as looking at that position,
+        // so if `last == end` afterwards, the result depends on the characters after the end.
+        class tracked_end
+        {
+        public:
+            // `last` is the furthest position looked at so far,
+            // it is initialized by the caller, usually to the beginning of the token
+            constexpr tracked_end(const char* end, const char*& last) noexcept
+            : end_(end), last_(&last)
+            {}
+
+            constexpr const char* get() const noexcept
+            {
+                return end_;
+            }
+
+            // records that the character at `ptr` was looked at,
+            // or the end, if it is at or after the end
+            constexpr void look_at(const char* ptr) const noexcept
+            {
+                if (ptr > end_)
+                    ptr = end_;
+                if (*last_ < ptr)
+                    *last_ = ptr;
+            }
+
+            friend constexpr bool operator==(const char* cur, const tracked_end& end) noexcept
+            {
+                end.look_at(cur);
+                return cur == end.end_;
+            }
+            friend constexpr bool operator==(const tracked_end& end, const char* cur) noexcept
+            {
+                return cur == end;
+            }
+
+            friend constexpr bool operator!=(const char* cur, const tracked_end& end) noexcept
+            {
+                return !(cur == end);
+            }
+            friend constexpr bool operator!=(const tracked_end& end, const char* cur) noexcept
+            {
+                return !(cur == end);
+            }
+
+        private:
+            const char*  end_;
+            const char** last_;
+        };
+
+        constexpr const char* get_end(const char* end) noexcept
+        {
+            return end;
+        }
+        constexpr const char* get_end(const tracked_end& end) noexcept
+        {
+            return end.get();
+        }
+
+        // records that the character at `ptr` was looked at, if the end is tracked
+        constexpr void look_at(const char*, const char*) noexcept {}
+        constexpr void look_at(const tracked_end& end, const char* ptr) noexcept
+        {
+            end.look_at(ptr);
+        }
+
+        template <class Rule, class End, typename = void>
+        struct can_track_end : std::false_type
+        {};
+        template <class Rule, class End>
+        struct can_track_end<Rule, End,
+                             decltype(void(Rule::try_match(std::declval<const char*>(),
+                                                           std::declval<End>())))>
+        : std::true_type
+        {};
+
+        template <class Rule, class End>
+        constexpr auto try_match_rule(std::true_type, const char* str, End end) noexcept
+        {
+            return Rule::try_match(str, end);
+        }
+        template <class Rule, class End>
+        constexpr auto try_match_rule(std::false_type, const char* str, End end) noexcept
+        {
+            // a handwritten rule can only be given a pointer,
+            // assume it has looked at the characters it consumed and the one after them
+            auto result = Rule::try_match(str, get_end(end));
+            look_at(end, str + result.bump);
+            return result;
+        }
+
+        // calls `Rule::try_match(str, end)`,
+        // passing it a plain pointer if the rule can't take the end type
+        template <class Rule, class End>
+        constexpr auto try_match_rule(const char* str, End end) noexcept
+        {
+            return try_match_rule<Rule>(can_track_end<Rule, End>{}, str, end);
+        }
+    } // namespace detail
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_DETAIL_TRACKED_END_HPP_INCLUDED
@@ -5,7 +5,10 @@
 #ifndef FOONATHAN_LEX_DETAIL_TRIE_HPP_INCLUDED
 #define FOONATHAN_LEX_DETAIL_TRIE_HPP_INCLUDED
 
+#include <utility>
+
 #include <foonathan/lex/detail/select_integer.hpp>
+#include <foonathan/lex/detail/tracked_end.hpp>
 #include <foonathan/lex/detail/type_list.hpp>
 #include <foonathan/lex/match_result.hpp>
 
@@ -15,6 +18,139 @@ namespace lex
 {
     namespace detail
     {
+        // a table mapping each character to the index of the child node starting with it,
+        // offset by one so that 0 means no child
+        template <class Children, class Indices = std::make_index_sequence<256>>
+        struct trie_dispatch_table;
+
+        template <class... Children, std::size_t... Indices>
+        struct trie_dispatch_table<type_list<Children...>, std::index_sequence<Indices...>>
+        {
+            using index_type = select_integer<sizeof...(Children) + 1>;
+
+            static constexpr index_type lookup(std::size_t c) noexcept
+            {
+                constexpr unsigned char characters[] = {
+                    static_cast<unsigned char>(Children::character)...};
+                for (auto i = 0u; i != sizeof...(Children); ++i)
+                    if (characters[i] == c)
+                        return static_cast<index_type>(i + 1);
+                return 0;
+            }
+
+            static constexpr index_type table[] = {lookup(Indices)...};
+        };
+
+        template <class... Children, std::size_t... Indices>
+        constexpr typename trie_dispatch_table<type_list<Children...>,
+                                               std::index_sequence<Indices...>>::index_type
+            trie_dispatch_table<type_list<Children...>, std::index_sequence<Indices...>>::table[];
+
+        // sorts the literals of a list, so that the literals sharing a prefix are adjacent,
+        // with the prefix itself first
+        //
+        // `List` provides the static members `count`, `strings`, `lengths` and `ids`.
+        template <class List>
+        struct trie_literal_order
+        {
+            static constexpr std::size_t count = List::count;
+
+            struct table
+            {
+                std::size_t index[count == 0 ? 1 : count];
+            };
+
+            static constexpr bool less(std::size_t lhs, std::size_t rhs) noexcept
+            {
+                auto lhs_length = List::lengths[lhs];
+                auto rhs_length = List::lengths[rhs];
+                for (auto i = 0u; i != lhs_length && i != rhs_length; ++i)
+                {
+                    auto lhs_char = static_cast<unsigned char>(List::strings[lhs][i]);
+                    auto rhs_char = static_cast<unsigned char>(List::strings[rhs][i]);
+                    if (lhs_char != rhs_char)
+                        return lhs_char < rhs_char;
+                }
+                return lhs_length < rhs_length;
+            }
+
+            static constexpr table build() noexcept
+            {
+                table result{};
+                for (auto i = 0u; i != count; ++i)
+                    result.index[i] = i;
+
+                // bottom-up merge sort
+                table buffer{};
+                for (std::size_t width = 1; width < count; width *= 2)
+                {
+                    for (std::size_t begin = 0; begin < count; begin += 2 * width)
+                    {
+                        auto middle = begin + width < count ? begin + width : count;
+                        auto end    = middle + width < count ? middle + width : count;
+
+                        auto lhs = begin;
+                        auto rhs = middle;
+                        for (auto cur = begin; cur != end; ++cur)
+                        {
+                            if (rhs == end
+                                || (lhs != middle && !less(result.index[rhs], result.index[lhs])))
+                                buffer.index[cur] = result.index[lhs++];
+                            else
+                                buffer.index[cur] = result.index[rhs++];
+                        }
+                    }
+
+                    for (auto i = 0u; i != count; ++i)
+                        result.index[i] = buffer.index[i];
+                }
+
+                return result;
+            }
+
+            static constexpr table value = build();
+
+            static constexpr std::size_t length_at(std::size_t i) noexcept
+            {
+                return List::lengths[value.index[i]];
+            }
+            static constexpr char char_at(std::size_t i, std::size_t depth) noexcept
+            {
+                return List::strings[value.index[i]][depth];
+            }
+            static constexpr auto id_at(std::size_t i) noexcept
+            {
+                return List::ids[value.index[i]];
+            }
+
+            // the literals in [first, last) share the first depth characters and are longer,
+            // they're grouped by the next character
+            static constexpr std::size_t group_count(std::size_t first, std::size_t last,
+                                                     std::size_t depth) noexcept
+            {
+                std::size_t result = 0;
+                for (auto i = first; i != last; ++i)
+                    if (i == first || char_at(i, depth) != char_at(i - 1, depth))
+                        ++result;
+                return result;
+            }
+            static constexpr std::size_t group_begin(std::size_t first, std::size_t last,
+                                                     std::size_t depth, std::size_t group) noexcept
+            {
+                for (auto i = first; i != last; ++i)
+                    if (i == first || char_at(i, depth) != char_at(i - 1, depth))
+                    {
+                        if (group == 0)
+                            return i;
+                        --group;
+                    }
+                return last;
+            }
+        };
+
+        template <class List>
+        constexpr typename trie_literal_order<List>::table trie_literal_order<List>::value;
+
         template <class TokenSpec>
         class trie
         {
@@ -60,35 +196,73 @@ namespace lex
                 typename insert_rule_into_children_impl<Rule, Children>::type;
 
             //=== nodes ===//
+            // nodes with more children than that use a dispatch table instead of comparing
+            // each character in turn
+            static constexpr std::size_t max_linear_children = 4;
+
+            template <class End, class... Children>
+            static constexpr auto match_child(std::false_type /* linear */, type_list<Children...>,
+                                              std::size_t length_so_far, const char* str,
+                                              End end) noexcept
+            {
+                auto result  = match_result<TokenSpec>::unmatched();
+                bool dummy[] = {(result.is_unmatched() && *str == Children::character
+                                 && (result = Children::match(length_so_far, str, end), true))...,
+                                true};
+                (void)dummy;
+                return result;
+            }
+            template <class End>
+            using match_child_fn = match_result<TokenSpec> (*)(std::size_t, const char*, End);
+
+            template <class End, class... Children>
+            static constexpr auto match_child_index(type_list<Children...>, std::size_t index,
+                                                    std::size_t length_so_far, const char* str,
+                                                    End end) noexcept
+            {
+                // indices are dense, so call through a table of the children
+                const match_child_fn<End> children[] = {&Children::template match<End>...};
+                return children[index - 1](length_so_far, str, end);
+            }
+            template <class End, class... Children>
+            static constexpr auto match_child(std::true_type /* dispatch table */,
+                                              type_list<Children...>, std::size_t length_so_far,
+                                              const char* str, End end) noexcept
+            {
+                using table = trie_dispatch_table<type_list<Children...>>;
+                auto index  = table::table[static_cast<unsigned char>(*str)];
+                if (index == 0)
+                    return match_result<TokenSpec>::unmatched();
+                return match_child_index(type_list<Children...>{}, index, length_so_far, str, end);
+            }
+
             // tries to match all children
-            template <class... Children>
+            template <class End, class... Children>
             static constexpr auto try_match_children(type_list<Children...>,
                                                      std::size_t length_so_far, const char* str,
-                                                     const char* end) noexcept
+                                                     End end) noexcept
             {
                 // need to check for EOF now
                 if (str == end)
                     return match_result<TokenSpec>::eof();
 
-                auto result  = match_result<TokenSpec>::unmatched();
-                bool dummy[] = {(result.is_unmatched() && *str == Children::character
-                                 && (result = Children::match(length_so_far, str, end), true))...,
-                                true};
-                (void)dummy;
-                return result;
+                using use_table
+                    = std::integral_constant<bool, (sizeof...(Children) > max_linear_children)>;
+                return match_child(use_table{}, type_list<Children...>{}, length_so_far, str, end);
             }
             // optimizations for 0 and 1
+            template <class End>
             static constexpr auto try_match_children(type_list<>, std::size_t, const char* str,
-                                                     const char* end) noexcept
+                                                     End end) noexcept
             {
                 if (str == end)
                     return match_result<TokenSpec>::eof();
                 else
                     return match_result<TokenSpec>::unmatched();
             }
-            template <class Child>
+            template <class End, class Child>
             static constexpr auto try_match_children(type_list<Child>, std::size_t length_so_far,
-                                                     const char* str, const char* end) noexcept
+                                                     const char* str, End end) noexcept
             {
                 if (str == end)
                     return match_result<TokenSpec>::eof();
@@ -99,32 +273,33 @@ namespace lex
             }
 
             // tries to match all rules
-            template <class... Rules>
+            template <class End, class... Rules>
             static constexpr auto try_match_rules(type_list<Rules...>, std::size_t length_so_far,
-                                                  const char* str, const char* end) noexcept
+                                                  const char* str, End end) noexcept
             {
                 // no need to check for EOF, only called after literal tokens
 
                 str -= length_so_far;
 
-                auto result = match_result<TokenSpec>::unmatched();
-                bool dummy[]
-                    = {(result.is_unmatched() && (result = Rules::try_match(str, end), true))...,
-                       true};
+                auto result  = match_result<TokenSpec>::unmatched();
+                bool dummy[] = {(result.is_unmatched()
+                                 && (result = try_match_rule<Rules>(str, end), true))...,
+                                true};
                 (void)dummy;
                 return result;
             }
             // optimizations for 0 and 1
+            template <class End>
             static constexpr auto try_match_rules(type_list<>, std::size_t, const char*,
-                                                  const char*) noexcept
+                                                  End) noexcept
             {
                 return match_result<TokenSpec>::unmatched();
             }
-            template <class Rule>
+            template <class End, class Rule>
             static constexpr auto try_match_rules(type_list<Rule>, std::size_t length_so_far,
-                                                  const char* str, const char* end) noexcept
+                                                  const char* str, End end) noexcept
             {
-                return Rule::try_match(str - length_so_far, end);
+                return try_match_rule<Rule>(str - length_so_far, end);
             }
 
             // a non-terminal node matching the given character
@@ -133,6 +308,7 @@ namespace lex
             {
                 static constexpr auto is_terminal = false;
                 using children                    = ChildNodes;
+                using rules                       = type_list<>;
                 static constexpr auto character   = C;
 
                 template <class Child>
@@ -143,8 +319,9 @@ namespace lex
                     // just insert the rule into all children
                     = non_terminal_node<C, insert_rule_into_children<Rule, ChildNodes>>;
 
+                template <class End>
                 static constexpr auto match(std::size_t length_so_far, const char* str,
-                                            const char* end) noexcept
+                                            End end) noexcept
                 {
                     return try_match_children(ChildNodes{}, length_so_far + 1, str + 1, end);
                 }
@@ -157,7 +334,9 @@ namespace lex
             {
                 static constexpr auto is_terminal = true;
                 using children                    = ChildNodes;
+                using rules                       = type_list<Rules...>;
                 static constexpr auto character   = C;
+                static constexpr auto id          = Id;
 
                 template <class Child>
                 using insert = terminal_node<C, Id, insert_node<Child, ChildNodes>, Rules...>;
@@ -171,8 +350,9 @@ namespace lex
                     // otherwise just into children
                     terminal_node<C, Id, insert_rule_into_children<Rule, ChildNodes>, Rules...>>;
 
+                template <class End>
                 static constexpr auto match(std::size_t length_so_far, const char* str,
-                                            const char* end) noexcept
+                                            End end) noexcept
                 {
                     ++length_so_far;
                     ++str;
@@ -203,6 +383,7 @@ namespace lex
             {
                 static constexpr auto is_terminal = false;
                 using children                    = ChildNodes;
+                using rules                       = type_list<Rules...>;
 
                 template <class Child>
                 using insert = root_node<insert_node<Child, ChildNodes>, Rules...>;
@@ -212,6 +393,23 @@ namespace lex
                     = root_node<insert_rule_into_children<Rule, ChildNodes>, Rules..., Rule>;
 
                 static constexpr auto try_match(const char* str, const char* end) noexcept
+                {
+                    return match(str, end);
+                }
+
+                static constexpr auto try_match(const char* str, const tracked_end& end) noexcept
+                {
+                    return match(str, end);
+                }
+
+                static constexpr auto try_match(const char* str, std::size_t size) noexcept
+                {
+                    return try_match(str, str + size);
+                }
+
+            private:
+                template <class End>
+                static constexpr auto match(const char* str, End end) noexcept
                 {
                     // match all literals
                     auto child_result = try_match_children(ChildNodes{}, 0, str, end);
@@ -226,11 +424,6 @@ namespace lex
                     // nothing matched, error
                     return match_result<TokenSpec>::error(1);
                 }
-
-                static constexpr auto try_match(const char* str, std::size_t size) noexcept
-                {
-                    return try_match(str, str + size);
-                }
             };
 
             //=== trie construction ===//
@@ -281,6 +474,88 @@ namespace lex
                 using type = typename insert_literal_impl<CurNode, Id, Char...>::type;
             };
 
+            //=== trie construction from sorted literals ===//
+            template <token_kind_detail::id_type<TokenSpec> Id>
+            struct conflicting_rule
+            {
+                template <class Rule>
+                using predicate = std::integral_constant<
+                    bool, Rule::is_conflicting_literal(token_kind<TokenSpec>::from_id(Id))>;
+            };
+
+            template <char C, token_kind_detail::id_type<TokenSpec> Id, class ChildNodes,
+                      class Rules>
+            struct make_terminal_node;
+            template <char C, token_kind_detail::id_type<TokenSpec> Id, class ChildNodes,
+                      class... Rules>
+            struct make_terminal_node<C, Id, ChildNodes, type_list<Rules...>>
+            {
+                using type = terminal_node<C, Id, ChildNodes, Rules...>;
+            };
+
+            // the node for the literals in [First, Last) of Order,
+            // which share their first Depth characters
+            template <class Order, class Rules, std::size_t First, std::size_t Last,
+                      std::size_t Depth, bool IsTerminal = Order::length_at(First) == Depth>
+            struct build_node;
+
+            template <class Order, class Rules, std::size_t First, std::size_t Last,
+                      std::size_t Depth,
+                      class Groups
+                      = std::make_index_sequence<Order::group_count(First, Last, Depth)>>
+            struct build_children;
+            template <class Order, class Rules, std::size_t First, std::size_t Last,
+                      std::size_t Depth, std::size_t... Groups>
+            struct build_children<Order, Rules, First, Last, Depth, std::index_sequence<Groups...>>
+            {
+                using type = type_list<typename build_node<
+                    Order, Rules, Order::group_begin(First, Last, Depth, Groups),
+                    Order::group_begin(First, Last, Depth, Groups + 1), Depth + 1>::type...>;
+            };
+
+            template <class Order, class Rules, std::size_t First, std::size_t Last,
+                      std::size_t Depth>
+            struct build_node<Order, Rules, First, Last, Depth, false>
+            {
+                static constexpr char character = Order::char_at(First, Depth - 1);
+
+                using children = typename build_children<Order, Rules, First, Last, Depth>::type;
+                using type     = non_terminal_node<character, children>;
+            };
+
+            template <class Order, class Rules, std::size_t First, std::size_t Last,
+                      std::size_t Depth>
+            struct build_node<Order, Rules, First, Last, Depth, true>
+            {
+                // the literal that ends here is sorted first
+                static_assert(First + 1 == Last || Order::length_at(First + 1) != Depth,
+                              "duplicate string insert into trie");
+
+                static constexpr char character = Order::char_at(First, Depth - 1);
+                static constexpr auto id        = Order::id_at(First);
+
+                using children
+                    = typename build_children<Order, Rules, First + 1, Last, Depth>::type;
+                using rules = keep_if<Rules, conflicting_rule<id>::template predicate>;
+                using type  = typename make_terminal_node<character, id, children, rules>::type;
+            };
+
+            template <class List, class Rules, bool Empty = List::count == 0>
+            struct build_root;
+            template <class List, class... Rules>
+            struct build_root<List, type_list<Rules...>, false>
+            {
+                using children = typename build_children<trie_literal_order<List>,
+                                                         type_list<Rules...>, 0, List::count,
+                                                         0>::type;
+                using type     = root_node<children, Rules...>;
+            };
+            template <class List, class... Rules>
+            struct build_root<List, type_list<Rules...>, true>
+            {
+                using type = root_node<type_list<>, Rules...>;
+            };
+
         public:
             // an empty trie
             using empty = root_node<type_list<>>;
@@ -293,6 +568,11 @@ namespace lex
             template <class Root, token_kind_detail::id_type<TokenSpec> Id, typename String>
             using insert_literal_str = typename insert_literal_str_impl<Root, Id, String>::type;
 
+            // builds a trie containing all literals of the list and then all rules at once,
+            // see `trie_literal_order` for the requirements on `List`
+            template <class List, class Rules = type_list<>>
+            using build = typename build_root<List, typename Rules::list>::type;
+
             // inserts a rule
             template <class Root, class Rule>
             using insert_rule = typename Root::template insert_rule<Rule>;
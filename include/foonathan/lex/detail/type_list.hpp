@@ -6,6 +6,7 @@
 #define FOONATHAN_LEX_DETAIL_TYPE_LIST_HPP_INCLUDED
 
 #include <type_traits>
+#include <utility>
 
 namespace foonathan
 {
@@ -69,21 +70,88 @@ namespace lex
         template <class List, typename... Ts>
         using concat = typename cat_impl<typename List::list, Ts...>::type;
 
+        //=== all_true/none_true/any_true ===//
+        template <bool... Bools>
+        struct bool_list
+        {};
+
+        template <bool... Bools>
+        using all_true
+            = std::is_same<bool_list<Bools..., true>, bool_list<true, Bools...>>; // neat trick
+        template <bool... Bools>
+        using none_true = all_true<(!Bools)...>; // none are true if all are false
+        template <bool... Bools>
+        using any_true
+            = std::integral_constant<bool, !none_true<Bools...>::value>; // if not none_true, then
+                                                                         // something must be true
+
+        //=== indexed access ===//
+        // All operations below are implemented using pack expansions and overload resolution,
+        // so their instantiation depth doesn't grow with the size of the list.
+        template <std::size_t I, typename T>
+        struct indexed_type
+        {
+            using type = T;
+        };
+
+        template <class Indices, typename... Ts>
+        struct indexed_types;
+        template <std::size_t... Indices, typename... Ts>
+        struct indexed_types<std::index_sequence<Indices...>, Ts...> : indexed_type<Indices, Ts>...
+        {};
+
+        template <class List>
+        struct make_indexed_types_impl;
+        template <typename... Ts>
+        struct make_indexed_types_impl<type_list<Ts...>>
+        {
+            using type = indexed_types<std::index_sequence_for<Ts...>, Ts...>;
+        };
+
+        // a type deriving from `indexed_type<I, T>` for each `T` at index `I`
+        template <class List>
+        using make_indexed_types = typename make_indexed_types_impl<typename List::list>::type;
+
+        template <std::size_t I, typename T>
+        indexed_type<I, T> select_indexed_type(const indexed_type<I, T>&);
+
+        // the calls are qualified to prevent ADL, which would consider all base classes
+        template <class List, std::size_t I>
+        using type_at = typename decltype(
+            detail::select_indexed_type<I>(std::declval<make_indexed_types<List>>()))::type;
+
         //=== index_of ===//
-        template <class List, typename T>
-        struct index_of_impl;
+        struct no_unique_index
+        {};
 
+        // deduction only succeeds if T is in the list exactly once
+        template <typename T, std::size_t I>
+        std::integral_constant<std::size_t, I> find_indexed_type(const indexed_type<I, T>&);
         template <typename T>
-        struct index_of_impl<type_list<>, T> : std::integral_constant<std::size_t, 0>
-        {};
+        no_unique_index find_indexed_type(...);
+
+        template <class List, typename T>
+        using unique_index_of
+            = decltype(detail::find_indexed_type<T>(std::declval<make_indexed_types<List>>()));
 
-        template <typename... Tail, typename T>
-        struct index_of_impl<type_list<T, Tail...>, T> : std::integral_constant<std::size_t, 0>
+        // the index of the first T, or the size if there is none
+        template <bool... Matches>
+        constexpr std::size_t first_match() noexcept
+        {
+            constexpr bool matches[] = {Matches..., true};
+            auto           result    = 0u;
+            while (!matches[result])
+                ++result;
+            return result;
+        }
+
+        template <class List, typename T, class UniqueIndex = unique_index_of<List, T>>
+        struct index_of_impl : UniqueIndex
         {};
 
-        template <typename Head, typename... Tail, typename T>
-        struct index_of_impl<type_list<Head, Tail...>, T>
-        : std::integral_constant<std::size_t, 1 + index_of_impl<type_list<Tail...>, T>::value>
+        template <typename... Ts, typename T>
+        struct index_of_impl<type_list<Ts...>, T, no_unique_index>
+        : std::integral_constant<std::size_t, first_match<std::is_same<Ts, T>::value...>()>
         {};
 
         template <class List, typename T>
@@ -93,52 +161,83 @@ namespace lex
         using contains = std::integral_constant<bool, (index_of<List, T>::value < List::size)>;
 
         //=== is_unique ===//
-        template <class Processed, class Rest>
+        template <class List>
         struct is_unique_impl;
 
-        template <class Processed>
-        struct is_unique_impl<Processed, type_list<>>
-        {
-            static constexpr bool value = true;
-        };
-
-        template <class Processed, typename Head, typename... Tail>
-        struct is_unique_impl<Processed, type_list<Head, Tail...>>
+        template <typename... Ts>
+        struct is_unique_impl<type_list<Ts...>>
         {
-            using head_duplicate = contains<Processed, Head>;
-            static constexpr bool tail_unique
-                = is_unique_impl<concat<Processed, Head>, type_list<Tail...>>::value;
-            static constexpr bool value = !head_duplicate::value && tail_unique;
+            using type = none_true<
+                std::is_same<unique_index_of<type_list<Ts...>, Ts>, no_unique_index>::value...>;
         };
 
         template <class List>
-        using is_unique = std::integral_constant<bool, is_unique_impl<type_list<>, List>::value>;
+        using is_unique = typename is_unique_impl<typename List::list>::type;
 
         //=== filter ===//
-        template <class List, template <typename> class Predicate>
-        struct filter_impl;
+        template <std::size_t N>
+        struct index_array
+        {
+            static constexpr auto size = N;
+            std::size_t           value[N == 0 ? 1 : N];
+        };
+
+        template <bool Value, bool... Flags>
+        constexpr std::size_t count_flags() noexcept
+        {
+            constexpr bool flags[] = {Flags..., !Value};
+            auto           result  = 0u;
+            for (auto flag : flags)
+                if (flag == Value)
+                    ++result;
+            return result;
+        }
 
-        template <template <typename> class Predicate>
-        struct filter_impl<type_list<>, Predicate>
+        // the indices of all flags that are equal to Value
+        template <bool Value, bool... Flags>
+        struct flag_indices
         {
-            using positive = type_list<>;
-            using negative = type_list<>;
+            using array = index_array<count_flags<Value, Flags...>()>;
+
+            static constexpr array build() noexcept
+            {
+                constexpr bool flags[] = {Flags..., !Value};
+                array          result{};
+                auto           cur = 0u;
+                for (auto i = 0u; i != sizeof...(Flags); ++i)
+                    if (flags[i] == Value)
+                        result.value[cur++] = i;
+                return result;
+            }
+
+            static constexpr array value = build();
         };
 
-        template <typename Head, typename... Tail, template <typename> class Predicate>
-        struct filter_impl<type_list<Head, Tail...>, Predicate>
+        template <bool Value, bool... Flags>
+        constexpr typename flag_indices<Value, Flags...>::array
+            flag_indices<Value, Flags...>::value;
+
+        template <class List, class Selected,
+                  class Indices = std::make_index_sequence<Selected::array::size>>
+        struct select_indices;
+        template <class List, class Selected, std::size_t... Indices>
+        struct select_indices<List, Selected, std::index_sequence<Indices...>>
         {
-            using tail          = filter_impl<type_list<Tail...>, Predicate>;
-            using tail_positive = typename tail::positive;
-            using tail_negative = typename tail::negative;
+            using type = type_list<type_at<List, Selected::value.value[Indices]>...>;
+        };
+
+        template <class List, template <typename> class Predicate>
+        struct filter_impl;
 
-            using head_positive = Predicate<Head>;
+        template <typename... Types, template <typename> class Predicate>
+        struct filter_impl<type_list<Types...>, Predicate>
+        {
+            using list = type_list<Types...>;
 
-            using positive
-                = std::conditional_t<head_positive::value, concat<type_list<Head>, tail_positive>,
-                                     tail_positive>;
-            using negative = std::conditional_t<head_positive::value, tail_negative,
-                                                concat<type_list<Head>, tail_negative>>;
+            using positive = typename select_indices<
+                list, flag_indices<true, bool(Predicate<Types>::value)...>>::type;
+            using negative = typename select_indices<
+                list, flag_indices<false, bool(Predicate<Types>::value)...>>::type;
         };
 
         template <class List, template <typename> class Predicate>
@@ -158,20 +257,6 @@ namespace lex
         using remove = remove_if<List, is_same_as<T>::template predicate>;
 
         //=== all_of/none_of/any_of ===//
-        template <bool... Bools>
-        struct bool_list
-        {};
-
-        template <bool... Bools>
-        using all_true
-            = std::is_same<bool_list<Bools..., true>, bool_list<true, Bools...>>; // neat trick
-        template <bool... Bools>
-        using none_true = all_true<(!Bools)...>; // none are true if all are false
-        template <bool... Bools>
-        using any_true
-            = std::integral_constant<bool, !none_true<Bools...>::value>; // if not none_true, then
-                                                                         // something must be true
-
         template <class List, template <typename T> class Pred>
         struct all_of_impl;
         template <typename... Types, template <typename T> class Pred>
@@ -5,6 +5,7 @@
 #ifndef FOONATHAN_LEX_GRAMMAR_HPP_INCLUDED
 #define FOONATHAN_LEX_GRAMMAR_HPP_INCLUDED
 
+#include <foonathan/lex/token.hpp>
 #include <foonathan/lex/token_spec.hpp>
 
 namespace foonathan
@@ -23,6 +24,27 @@ namespace lex
     {
         struct base_production : production_rule::production_adl
         {};
+
+        // callback used when parsing with a parse_memo, see parse_memo.hpp
+        template <class Grammar, class Func>
+        class memo_callback;
+
+        // base class of the productions that adds the overload of parse() used with a parse_memo
+        template <class Derived, class Grammar>
+        struct memoizable_production : base_production
+        {
+            template <class Func>
+            static auto parse(tokenizer<typename Grammar::token_spec>& tokenizer,
+                              memo_callback<Grammar, Func>&            f)
+            {
+                // the rvalue doesn't bind to this overload but to the regular parse() of the
+                // production, which passes it on as lvalue, so nested productions are memoized
+                return f.template memoize<Derived>(tokenizer, [&] {
+                    return Derived::parse(tokenizer,
+                                          static_cast<memo_callback<Grammar, Func>&&>(f));
+                });
+            }
+        };
     } // namespace detail
 
     /// Whether or not the given type is a production.
@@ -157,7 +157,7 @@ namespace lex
     } // namespace detail
 
     template <class Derived, class Grammar>
-    class list_production : public detail::base_production
+    class list_production : public detail::memoizable_production<Derived, Grammar>
     {
     public:
         using element = void;
@@ -167,6 +167,8 @@ namespace lex
         using allow_empty     = std::false_type;
         using allow_trailing  = std::false_type;
 
+        using detail::memoizable_production<Derived, Grammar>::parse;
+
         template <class Func>
         static constexpr auto parse(tokenizer<typename Grammar::token_spec>& tokenizer, Func&& f)
         {
@@ -195,7 +197,7 @@ namespace lex
     };
 
     template <class Derived, class Grammar>
-    class bracketed_list_production : public detail::base_production
+    class bracketed_list_production : public detail::memoizable_production<Derived, Grammar>
     {
     public:
         using element       = void;
@@ -206,6 +208,8 @@ namespace lex
         using allow_empty     = std::false_type;
         using allow_trailing  = std::false_type;
 
+        using detail::memoizable_production<Derived, Grammar>::parse;
+
         template <class Func>
         static constexpr auto parse(tokenizer<typename Grammar::token_spec>& tokenizer, Func&& f)
         {
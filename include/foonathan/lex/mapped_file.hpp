@@ -0,0 +1,274 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_MAPPED_FILE_HPP_INCLUDED
+#define FOONATHAN_LEX_MAPPED_FILE_HPP_INCLUDED
+
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    define FOONATHAN_LEX_DETAIL_HAS_MMAP 1
+#    include <cerrno>
+#    include <cstring>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <new>
+#    include <unistd.h>
+#else
+#    define FOONATHAN_LEX_DETAIL_HAS_MMAP 0
+#    include <cstdio>
+#    include <new>
+#endif
+
+namespace foonathan
+{
+namespace lex
+{
+    /// The read-only contents of a file, mapped into memory.
+    ///
+    /// On POSIX systems, the file is mapped using `mmap()`,
+    /// so the contents are read lazily by the OS and never copied.
+    /// The mapping is advised for sequential access, which is how a tokenizer reads it.
+    /// Files that can't be mapped, like pipes, are read into a buffer,
+    /// as are all files on other systems.
+    ///
+    /// It can be passed to a tokenizer using `begin()` and `end()`;
+    /// the spellings of the tokens then point directly into the mapping.
+    class mapped_file
+    {
+    public:
+        //=== constructors ===//
+        /// \effects Creates it without a file.
+        mapped_file() noexcept : data_(nullptr), size_(0), mapped_(false) {}
+
+        /// \effects Maps the specified file.
+        /// If the file could not be opened, the object will not have a file.
+        explicit mapped_file(const char* path) noexcept : mapped_file()
+        {
+            map(path);
+        }
+
+        mapped_file(mapped_file&& other) noexcept
+        : data_(other.data_), size_(other.size_), mapped_(other.mapped_)
+        {
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+
+        ~mapped_file() noexcept
+        {
+            unmap();
+        }
+
+        mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            if (this != &other)
+            {
+                unmap();
+                data_       = other.data_;
+                size_       = other.size_;
+                mapped_     = other.mapped_;
+                other.data_ = nullptr;
+                other.size_ = 0;
+            }
+            return *this;
+        }
+
+        //=== access ===//
+        /// \returns Whether or not it has a file.
+        /// \notes An empty file is still a file.
+        bool is_open() const noexcept
+        {
+            return data_ != nullptr;
+        }
+
+        /// \returns `is_open()`.
+        explicit operator bool() const noexcept
+        {
+            return is_open();
+        }
+
+        /// \returns A pointer to the contents of the file, or `nullptr` if there is no file.
+        const char* data() const noexcept
+        {
+            return data_;
+        }
+
+        /// \returns The number of characters in the file.
+        std::size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        /// \returns `data()`.
+        const char* begin() const noexcept
+        {
+            return data_;
+        }
+
+        /// \returns `data() + size()`.
+        const char* end() const noexcept
+        {
+            return data_ + size_;
+        }
+
+    private:
+        // used for empty files, which can't be mapped
+        static const char* empty() noexcept
+        {
+            return "";
+        }
+
+#if FOONATHAN_LEX_DETAIL_HAS_MMAP
+        void map(const char* path) noexcept
+        {
+            auto fd = ::open(path, O_RDONLY);
+            if (fd == -1)
+                return;
+
+            struct stat info;
+            if (::fstat(fd, &info) == 0)
+            {
+                auto size = static_cast<std::size_t>(info.st_size);
+                if (!S_ISREG(info.st_mode) || size == 0)
+                    // not a regular file or one whose size is unknown, like in /proc
+                    read(fd);
+                else
+                {
+                    auto memory = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (memory != MAP_FAILED)
+                    {
+                        advise(memory, size);
+                        data_   = static_cast<const char*>(memory);
+                        size_   = size;
+                        mapped_ = true;
+                    }
+                    else
+                        // e.g. out of address space or a file system that doesn't support it
+                        read(fd);
+                }
+            }
+
+            // the mapping keeps the file alive
+            ::close(fd);
+        }
+
+        // reads everything until EOF, as the size is not known upfront
+        void read(int fd) noexcept
+        {
+            std::size_t capacity = 4096u;
+            std::size_t size     = 0u;
+            auto        buffer   = new (std::nothrow) char[capacity];
+            while (buffer)
+            {
+                auto result = ::read(fd, buffer + size, capacity - size);
+                if (result == 0)
+                    break;
+                else if (result < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    // e.g. a directory
+                    delete[] buffer;
+                    return;
+                }
+
+                size += static_cast<std::size_t>(result);
+                if (size == capacity)
+                {
+                    auto bigger = new (std::nothrow) char[2 * capacity];
+                    if (bigger)
+                        std::memcpy(bigger, buffer, size);
+                    delete[] buffer;
+                    buffer = bigger;
+                    capacity *= 2;
+                }
+            }
+
+            if (!buffer)
+                return;
+            else if (size == 0)
+            {
+                delete[] buffer;
+                data_ = empty();
+            }
+            else
+            {
+                data_ = buffer;
+                size_ = size;
+            }
+        }
+
+        static void advise(void* memory, std::size_t size) noexcept
+        {
+            constexpr auto big_size = 2 * 1024 * 1024u;
+
+            // the hints are only an optimization, so errors are ignored
+            (void)::madvise(memory, size, MADV_SEQUENTIAL);
+            if (size < big_size)
+                // a small file can be read upfront,
+                // a big one is only read ahead as it is needed to keep the memory use bounded
+                (void)::madvise(memory, size, MADV_WILLNEED);
+#    if defined(MADV_HUGEPAGE)
+            else
+                // fewer TLB misses when streaming through big files
+                (void)::madvise(memory, size, MADV_HUGEPAGE);
+#    endif
+        }
+
+        void unmap() noexcept
+        {
+            if (size_ == 0)
+                return;
+            else if (mapped_)
+                ::munmap(const_cast<char*>(data_), size_);
+            else
+                delete[] data_;
+        }
+#else
+        void map(const char* path) noexcept
+        {
+            auto file = std::fopen(path, "rb");
+            if (!file)
+                return;
+
+            if (std::fseek(file, 0, SEEK_END) == 0)
+            {
+                auto size = std::ftell(file);
+                if (size == 0)
+                    data_ = empty();
+                else if (size > 0 && std::fseek(file, 0, SEEK_SET) == 0)
+                {
+                    auto buffer = new (std::nothrow) char[static_cast<std::size_t>(size)];
+                    if (buffer
+                        && std::fread(buffer, 1, static_cast<std::size_t>(size), file)
+                               == static_cast<std::size_t>(size))
+                    {
+                        data_ = buffer;
+                        size_ = static_cast<std::size_t>(size);
+                    }
+                    else
+                        delete[] buffer;
+                }
+            }
+
+            std::fclose(file);
+        }
+
+        void unmap() noexcept
+        {
+            if (size_ != 0)
+                delete[] data_;
+        }
+#endif
+
+        const char* data_;
+        std::size_t size_;
+        bool        mapped_; // whether data_ is a mapping or a buffer allocated by new[]
+    };
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_MAPPED_FILE_HPP_INCLUDED
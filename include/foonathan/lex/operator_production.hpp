@@ -5,6 +5,7 @@
 #ifndef FOONATHAN_LEX_OPERATOR_PRODUCTION_HPP_INCLUDED
 #define FOONATHAN_LEX_OPERATOR_PRODUCTION_HPP_INCLUDED
 
+#include <foonathan/lex/detail/select_integer.hpp>
 #include <foonathan/lex/grammar.hpp>
 #include <foonathan/lex/parser.hpp>
 #include <foonathan/lex/tokenizer.hpp>
@@ -19,6 +20,23 @@ namespace lex
         struct operator_adl
         {};
 
+        /// Tag type to select the engine that parses an operator rule with one function per level
+        /// of the precedence hierarchy.
+        ///
+        /// This is the default.
+        struct recursive_descent_engine
+        {};
+
+        /// Tag type to select the engine that parses an operator rule using precedence climbing.
+        ///
+        /// The precedence hierarchy is flattened into tables at compile-time,
+        /// which are then used by a loop that only recurses to parse operands.
+        /// Parsing an operand thus no longer requires one call per level of the hierarchy.
+        /// Select it by adding `using engine = lex::operator_rule::precedence_climbing_engine;` to
+        /// the [lex::operator_production]().
+        struct precedence_climbing_engine
+        {};
+
         namespace detail
         {
             template <class TLP, class Func>
@@ -40,6 +58,56 @@ namespace lex
                 }
             };
 
+            //=== operator_table ===//
+            // maps each token to the index of the first group containing it, or to no_group
+            template <class TokenSpec, class... Groups>
+            struct operator_table
+            {
+                static constexpr std::size_t token_count = TokenSpec::size + 2;
+                static constexpr std::size_t no_group    = sizeof...(Groups);
+
+                using index_type = lex::detail::select_integer<no_group>;
+
+                struct table
+                {
+                    index_type group[token_count];
+                };
+
+                template <class... Tokens>
+                static constexpr bool insert(table& result, std::size_t group,
+                                             lex::detail::type_list<Tokens...>) noexcept
+                {
+                    std::size_t ids[] = {token_kind_detail::get_id<TokenSpec, Tokens>()..., 0};
+                    for (auto i = 0u; i != sizeof...(Tokens); ++i)
+                        if (result.group[ids[i]] == no_group)
+                            result.group[ids[i]] = static_cast<index_type>(group);
+                    return true;
+                }
+
+                static constexpr table build() noexcept
+                {
+                    table result{};
+                    for (auto i = 0u; i != token_count; ++i)
+                        result.group[i] = static_cast<index_type>(no_group);
+
+                    std::size_t group = 0;
+                    bool dummy[] = {insert(result, group++, typename Groups::list{})..., true};
+                    (void)dummy;
+                    return result;
+                }
+
+                static constexpr table value = build();
+
+                static constexpr std::size_t lookup(const token<TokenSpec>& token) noexcept
+                {
+                    return value.group[token.kind().get()];
+                }
+            };
+
+            template <class TokenSpec, class... Groups>
+            constexpr typename operator_table<TokenSpec, Groups...>::table
+                operator_table<TokenSpec, Groups...>::value;
+
             //=== operator_spelling ===//
             template <class... Tokens>
             struct operator_spelling
@@ -50,33 +118,60 @@ namespace lex
 
                 using token_list = lex::detail::type_list<Tokens...>;
 
+                template <class TokenSpec>
+                using table = operator_table<TokenSpec, lex::detail::type_list<Tokens>...>;
+
+                template <class TokenSpec>
+                static constexpr std::size_t index(const token<TokenSpec>& token)
+                {
+                    return table<TokenSpec>::lookup(token);
+                }
+
                 template <class TokenSpec>
                 static constexpr bool match(const token<TokenSpec>& token)
                 {
-                    bool result[] = {token.is(Tokens{})..., false};
-                    for (auto value : result)
-                        if (value)
-                            return true;
-                    return false;
+                    return index(token) != sizeof...(Tokens);
                 }
 
+                template <class TLP, class Func>
+                using result_of = decltype(op_parse_result<TLP, Func>::result);
+
+                template <class Token, class Func, class TLP, class TokenSpec>
+                static constexpr result_of<TLP, Func> apply_prefix_token(
+                    Func& f, const token<TokenSpec>& op, op_parse_result<TLP, Func>& value)
+                {
+                    return lex::detail::apply_parse_result(f, TLP{}, lex::static_token<Token>(op),
+                                                           value.forward());
+                }
+                template <class Token, class Func, class TLP, class TokenSpec>
+                static constexpr result_of<TLP, Func> apply_postfix_token(
+                    Func& f, const token<TokenSpec>& op, op_parse_result<TLP, Func>& value)
+                {
+                    return lex::detail::apply_parse_result(f, TLP{}, value.forward(),
+                                                           lex::static_token<Token>(op));
+                }
+                template <class Token, class Func, class TLP, class TokenSpec>
+                static constexpr result_of<TLP, Func> apply_binary_token(
+                    Func& f, const token<TokenSpec>& op, op_parse_result<TLP, Func>& lhs,
+                    op_parse_result<TLP, Func>& rhs)
+                {
+                    return lex::detail::apply_parse_result(f, TLP{}, lhs.forward(),
+                                                           lex::static_token<Token>(op),
+                                                           rhs.forward());
+                }
+
+                // the apply functions call the one of the operator through a table indexed by it
                 template <class Func, class TLP, class TokenSpec>
                 static constexpr op_parse_result<TLP, Func> apply_prefix(
                     Func& f, TLP, const token<TokenSpec>& op, op_parse_result<TLP, Func>& value)
                 {
-                    op_parse_result<TLP, Func> result;
-                    result.op = op;
-
-                    bool dummy[]
-                        = {(op.is(Tokens{})
-                            && (result.result
-                                = lex::detail::apply_parse_result(f, TLP{},
-                                                                  lex::static_token<Tokens>(op),
-                                                                  value.forward()),
-                                false))...,
-                           false};
-                    (void)dummy;
+                    using apply_fn = result_of<TLP, Func> (*)(Func&, const token<TokenSpec>&,
+                                                              op_parse_result<TLP, Func>&);
+                    const apply_fn apply[] = {&apply_prefix_token<Tokens, Func, TLP, TokenSpec>...};
 
+                    op_parse_result<TLP, Func> result;
+                    result.op     = op;
+                    result.result = apply[index(op)](f, op, value);
                     return result;
                 }
 
@@ -84,18 +179,14 @@ namespace lex
                 static constexpr op_parse_result<TLP, Func> apply_postfix(
                     Func& f, TLP, op_parse_result<TLP, Func>& value, const token<TokenSpec>& op)
                 {
-                    op_parse_result<TLP, Func> result;
-                    result.op = op;
-
-                    bool dummy[]
-                        = {(op.is(Tokens{})
-                            && (result.result
-                                = lex::detail::apply_parse_result(f, TLP{}, value.forward(),
-                                                                  lex::static_token<Tokens>(op)),
-                                false))...,
-                           false};
-                    (void)dummy;
+                    using apply_fn = result_of<TLP, Func> (*)(Func&, const token<TokenSpec>&,
+                                                              op_parse_result<TLP, Func>&);
+                    const apply_fn apply[]
+                        = {&apply_postfix_token<Tokens, Func, TLP, TokenSpec>...};
 
+                    op_parse_result<TLP, Func> result;
+                    result.op     = op;
+                    result.result = apply[index(op)](f, op, value);
                     return result;
                 }
 
@@ -104,19 +195,15 @@ namespace lex
                     Func& f, TLP, op_parse_result<TLP, Func>& lhs, const token<TokenSpec>& op,
                     op_parse_result<TLP, Func>& rhs)
                 {
-                    op_parse_result<TLP, Func> result;
-                    result.op = op;
-
-                    bool dummy[]
-                        = {(op.is(Tokens{})
-                            && (result.result
-                                = lex::detail::apply_parse_result(f, TLP{}, lhs.forward(),
-                                                                  lex::static_token<Tokens>(op),
-                                                                  rhs.forward()),
-                                false))...,
-                           false};
-                    (void)dummy;
+                    using apply_fn
+                        = result_of<TLP, Func> (*)(Func&, const token<TokenSpec>&,
+                                                   op_parse_result<TLP, Func>&,
+                                                   op_parse_result<TLP, Func>&);
+                    const apply_fn apply[] = {&apply_binary_token<Tokens, Func, TLP, TokenSpec>...};
 
+                    op_parse_result<TLP, Func> result;
+                    result.op     = op;
+                    result.result = apply[index(op)](f, op, lhs, rhs);
                     return result;
                 }
             };
@@ -511,6 +598,422 @@ namespace lex
                 }
             };
 
+            //=== precedence climbing ===//
+            // a level of the precedence hierarchy, the primary template is the bottom operand
+            template <class Operand>
+            struct climbing_level
+            {
+                static constexpr bool is_level = false;
+            };
+
+            // parse() parses the operator at the given level, lhs is unused for prefix operators
+            template <associativity Assoc, class Operator, class Operand>
+            struct climbing_level<prefix_op<Assoc, Operator, Operand>>
+            {
+                static constexpr bool is_level  = true;
+                static constexpr bool is_prefix = true;
+                static constexpr bool is_single = Assoc == single;
+
+                using operand = Operand;
+                using tokens  = typename Operator::token_list;
+
+                template <class TLP, class Parser, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                            std::size_t level, op_parse_result<TLP, Func>&)
+                    -> op_parse_result<TLP, Func>
+                {
+                    auto op      = tokenizer.get();
+                    auto operand = Parser::template parse_expr<TLP>(tokenizer, f,
+                                                                    is_single ? level + 1 : level);
+                    if (operand.is_unmatched())
+                        return operand;
+
+                    return Operator::apply_prefix(f, TLP{}, op, operand);
+                }
+            };
+
+            template <associativity Assoc, class Operator, class Production, class Operand>
+            struct climbing_level<prefix_prod<Assoc, Operator, Production, Operand>>
+            {
+                static constexpr bool is_level  = true;
+                static constexpr bool is_prefix = true;
+                static constexpr bool is_single = Assoc == single;
+
+                using operand = Operand;
+                using tokens  = typename Operator::token_list;
+
+                template <class TLP, class Parser, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                            std::size_t level, op_parse_result<TLP, Func>&)
+                    -> op_parse_result<TLP, Func>
+                {
+                    auto op_token = tokenizer.peek();
+                    auto op       = Production::parse(tokenizer, f);
+                    if (op.is_unmatched())
+                        return {};
+
+                    auto operand = Parser::template parse_expr<TLP>(tokenizer, f,
+                                                                    is_single ? level + 1 : level);
+                    if (operand.is_unmatched())
+                        return operand;
+
+                    return {lex::detail::apply_parse_result(f, TLP{},
+                                                            op.template forward<Production>(),
+                                                            operand.forward()),
+                            op_token};
+                }
+            };
+
+            template <associativity Assoc, class Operator, class Operand>
+            struct climbing_level<postfix_op<Assoc, Operator, Operand>>
+            {
+                static constexpr bool is_level  = true;
+                static constexpr bool is_prefix = false;
+                static constexpr bool is_single = Assoc == single;
+
+                using operand = Operand;
+                using tokens  = typename Operator::token_list;
+
+                template <class TLP, class Parser, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f, std::size_t,
+                                            op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    auto op = tokenizer.get();
+                    return Operator::apply_postfix(f, TLP{}, lhs, op);
+                }
+            };
+
+            template <associativity Assoc, class Operator, class Production, class Operand>
+            struct climbing_level<postfix_prod<Assoc, Operator, Production, Operand>>
+            {
+                static constexpr bool is_level  = true;
+                static constexpr bool is_prefix = false;
+                static constexpr bool is_single = Assoc == single;
+
+                using operand = Operand;
+                using tokens  = typename Operator::token_list;
+
+                template <class TLP, class Parser, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f, std::size_t,
+                                            op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    auto op_token = tokenizer.peek();
+                    auto op       = Production::parse(tokenizer, f);
+                    if (op.is_unmatched())
+                        return {};
+
+                    return {lex::detail::apply_parse_result(f, TLP{}, lhs.forward(),
+                                                            op.template forward<Production>()),
+                            op_token};
+                }
+            };
+
+            template <associativity Assoc, class Operator, class Operand>
+            struct climbing_level<binary_op<Assoc, Operator, Operand>>
+            {
+                static constexpr bool is_level  = true;
+                static constexpr bool is_prefix = false;
+                static constexpr bool is_single = Assoc == single;
+
+                using operand = Operand;
+                using tokens  = typename Operator::token_list;
+
+                template <class TLP, class Parser, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                            std::size_t level, op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    auto op      = tokenizer.get();
+                    auto operand = Parser::template parse_expr<TLP>(tokenizer, f,
+                                                                    Assoc == right ? level
+                                                                                   : level + 1);
+                    if (operand.is_unmatched())
+                        return operand;
+
+                    return Operator::apply_binary(f, TLP{}, lhs, op, operand);
+                }
+            };
+
+            template <associativity Assoc, class Operator, class Production, class Operand>
+            struct climbing_level<binary_prod<Assoc, Operator, Production, Operand>>
+            {
+                static constexpr bool is_level  = true;
+                static constexpr bool is_prefix = false;
+                static constexpr bool is_single = Assoc == single;
+
+                using operand = Operand;
+                using tokens  = typename Operator::token_list;
+
+                template <class TLP, class Parser, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                            std::size_t level, op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    auto op_token = tokenizer.peek();
+                    auto op       = Production::parse(tokenizer, f);
+                    if (op.is_unmatched())
+                        return {};
+
+                    auto operand = Parser::template parse_expr<TLP>(tokenizer, f,
+                                                                    Assoc == right ? level
+                                                                                   : level + 1);
+                    if (operand.is_unmatched())
+                        return operand;
+
+                    return {lex::detail::apply_parse_result(f, TLP{}, lhs.forward(),
+                                                            op.template forward<Production>(),
+                                                            operand.forward()),
+                            op_token};
+                }
+            };
+
+            // the levels of an operand, from the lowest to the highest precedence
+            template <class Operand, bool IsLevel = climbing_level<Operand>::is_level>
+            struct climbing_chain
+            {
+                using levels = lex::detail::type_list<>;
+                using bottom = Operand;
+            };
+            template <class Level>
+            struct climbing_chain<Level, true>
+            {
+                using operand_chain = climbing_chain<typename climbing_level<Level>::operand>;
+
+                using levels = lex::detail::concat<lex::detail::type_list<Level>,
+                                                   typename operand_chain::levels>;
+                using bottom = typename operand_chain::bottom;
+            };
+
+            template <class TokenSpec, class Levels>
+            struct climbing_table;
+            template <class TokenSpec, class... Levels>
+            struct climbing_table<TokenSpec, lex::detail::type_list<Levels...>>
+            {
+                static constexpr std::size_t token_count = TokenSpec::size + 2;
+                static constexpr std::size_t level_count = sizeof...(Levels);
+                static constexpr std::size_t no_level    = level_count;
+
+                using index_type = lex::detail::select_integer<level_count>;
+
+                struct table
+                {
+                    // prefix[min][id]: the first prefix level >= min with that operator
+                    index_type prefix[level_count + 1][token_count];
+                    // left[end][id]: the last postfix or binary level < end with that operator
+                    index_type left[level_count + 1][token_count];
+                    // whether an operator of that level can only be used once
+                    bool single[level_count + 1];
+                };
+
+                template <class... Tokens>
+                static constexpr bool insert(bool (&is_operator)[token_count],
+                                             lex::detail::type_list<Tokens...>) noexcept
+                {
+                    std::size_t ids[] = {token_kind_detail::get_id<TokenSpec, Tokens>()..., 0};
+                    for (auto i = 0u; i != sizeof...(Tokens); ++i)
+                        is_operator[ids[i]] = true;
+                    return true;
+                }
+
+                static constexpr table build() noexcept
+                {
+                    bool is_prefix[] = {climbing_level<Levels>::is_prefix..., false};
+                    bool is_single[] = {climbing_level<Levels>::is_single..., false};
+
+                    bool is_operator[level_count + 1][token_count] = {};
+
+                    std::size_t level = 0;
+                    bool        dummy[]
+                        = {insert(is_operator[level++],
+                                  typename climbing_level<Levels>::tokens{})...,
+                           true};
+                    (void)dummy;
+
+                    table result{};
+                    for (auto id = 0u; id != token_count; ++id)
+                    {
+                        result.prefix[level_count][id] = static_cast<index_type>(no_level);
+                        for (auto min = level_count; min-- != 0u;)
+                            result.prefix[min][id] = is_prefix[min] && is_operator[min][id]
+                                                         ? static_cast<index_type>(min)
+                                                         : result.prefix[min + 1][id];
+
+                        result.left[0][id] = static_cast<index_type>(no_level);
+                        for (auto end = 1u; end <= level_count; ++end)
+                            result.left[end][id] = !is_prefix[end - 1] && is_operator[end - 1][id]
+                                                       ? static_cast<index_type>(end - 1)
+                                                       : result.left[end - 1][id];
+                    }
+                    for (auto i = 0u; i != level_count; ++i)
+                        result.single[i] = is_single[i];
+
+                    return result;
+                }
+
+                static constexpr table value = build();
+            };
+
+            template <class TokenSpec, class... Levels>
+            constexpr typename climbing_table<TokenSpec, lex::detail::type_list<Levels...>>::table
+                climbing_table<TokenSpec, lex::detail::type_list<Levels...>>::value;
+
+            // parses an operand and its operators using precedence climbing
+            //
+            // The levels of the operand are numbered starting at zero for the lowest precedence.
+            // After an operator has been parsed, only operators of the same or a lower level
+            // can follow, just like the recursive descent engine handles one level after the
+            // other.
+            template <class Operand>
+            struct climbing_parser
+            {
+                using levels = typename climbing_chain<Operand>::levels;
+                using bottom = typename climbing_chain<Operand>::bottom;
+
+                template <class TokenSpec>
+                using table = climbing_table<TokenSpec, levels>;
+
+                // parses the operator of the given level through a table indexed by the level
+                template <class TLP, class... Levels, class TokenSpec, class Func>
+                static constexpr auto parse_level(lex::detail::type_list<Levels...>,
+                                                  std::size_t                 level,
+                                                  tokenizer<TokenSpec>&       tokenizer, Func& f,
+                                                  op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    using parse_fn
+                        = op_parse_result<TLP, Func> (*)(lex::tokenizer<TokenSpec>&, Func&,
+                                                         std::size_t, op_parse_result<TLP, Func>&);
+                    const parse_fn level_parsers[]
+                        = {&climbing_level<Levels>::template parse<TLP, climbing_parser, TokenSpec,
+                                                                   Func>...};
+                    return level_parsers[level](tokenizer, f, level, lhs);
+                }
+
+                // parses a prefix operator of a level >= min, or the bottom operand
+                template <class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_null(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                                 std::size_t min) -> op_parse_result<TLP, Func>
+                {
+                    std::size_t level
+                        = table<TokenSpec>::value.prefix[min][tokenizer.peek().kind().get()];
+                    if (level == table<TokenSpec>::no_level)
+                        return bottom::template parse_null<TLP>(tokenizer, f);
+
+                    op_parse_result<TLP, Func> no_lhs;
+                    return parse_level<TLP>(levels{}, level, tokenizer, f, no_lhs);
+                }
+
+                // parses all following postfix and binary operators of a level >= min
+                template <class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_left(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                                 op_parse_result<TLP, Func>& lhs, std::size_t min)
+                    -> op_parse_result<TLP, Func>
+                {
+                    std::size_t end = table<TokenSpec>::level_count;
+                    while (true)
+                    {
+                        std::size_t level
+                            = table<TokenSpec>::value.left[end][tokenizer.peek().kind().get()];
+                        if (level == table<TokenSpec>::no_level || level < min)
+                            break;
+
+                        lhs = parse_level<TLP>(levels{}, level, tokenizer, f, lhs);
+                        if (lhs.is_unmatched())
+                            break;
+
+                        end = table<TokenSpec>::value.single[level] ? level : level + 1;
+                    }
+
+                    return static_cast<op_parse_result<TLP, Func>&&>(lhs);
+                }
+
+                // parses an operand using only the levels >= min
+                template <class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_expr(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                                 std::size_t min) -> op_parse_result<TLP, Func>
+                {
+                    auto lhs = parse_null<TLP>(tokenizer, f, min);
+                    if (lhs.is_unmatched())
+                        return lhs;
+
+                    return parse_left<TLP>(tokenizer, f, lhs, min);
+                }
+            };
+
+            //=== engine selection ===//
+            template <class TLP, typename = void>
+            struct operator_engine
+            {
+                using type = recursive_descent_engine;
+            };
+
+            template <class TLP>
+            struct operator_engine<TLP, decltype(void(typename TLP::engine{}))>
+            {
+                using type = typename TLP::engine;
+            };
+
+            // parses a child of a rule
+            template <class Engine>
+            struct engine_parser;
+
+            template <>
+            struct engine_parser<recursive_descent_engine>
+            {
+                template <class Child, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f)
+                    -> op_parse_result<TLP, Func>
+                {
+                    return detail::parse<Child, TLP>(tokenizer, f);
+                }
+
+                template <class Child, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_null(tokenizer<TokenSpec>& tokenizer, Func& f)
+                    -> op_parse_result<TLP, Func>
+                {
+                    return Child::template parse_null<TLP>(tokenizer, f);
+                }
+
+                template <class Child, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_left(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                                 op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    return Child::template parse_left<TLP>(tokenizer, f, lhs);
+                }
+            };
+
+            template <>
+            struct engine_parser<precedence_climbing_engine>
+            {
+                template <class Child, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f)
+                    -> op_parse_result<TLP, Func>
+                {
+                    return climbing_parser<Child>::template parse_expr<TLP>(tokenizer, f, 0);
+                }
+
+                template <class Child, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_null(tokenizer<TokenSpec>& tokenizer, Func& f)
+                    -> op_parse_result<TLP, Func>
+                {
+                    return climbing_parser<Child>::template parse_null<TLP>(tokenizer, f, 0);
+                }
+
+                template <class Child, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_left(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                                 op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    return climbing_parser<Child>::template parse_left<TLP>(tokenizer, f, lhs, 0);
+                }
+            };
+
+            template <class TLP>
+            using engine_parser_for = engine_parser<typename operator_engine<TLP>::type>;
+
             template <class Child, class... Children>
             struct rule : operator_adl
             {
@@ -523,61 +1026,83 @@ namespace lex
                     lex::detail::is_unique<pre_tokens>::value,
                     "operator choice cannot uniquely decide a path based on a prefix operator, "
                     "try extracting common operands as a separate production");
+                static_assert(
+                    lex::detail::is_unique<post_tokens>::value,
+                    "operator choice cannot uniquely decide a path based on a postfix or binary "
+                    "operator, try extracting common operands as a separate production");
+
+                // the first child that can parse a prefix or left operator of the given token
+                template <class TokenSpec>
+                using prefix_table = operator_table<TokenSpec, typename Child::pre_tokens,
+                                                    typename Children::pre_tokens...>;
+                template <class TokenSpec>
+                using left_table = operator_table<TokenSpec, typename Child::post_tokens,
+                                                  typename Children::post_tokens...>;
 
+                template <class Head, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_left_child(tokenizer<TokenSpec>& tokenizer, Func& f,
+                                                       op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
+                {
+                    // Head is the first child that has a left operator
+                    return engine_parser_for<TLP>::template parse_left<Head, TLP>(tokenizer, f,
+                                                                                   lhs);
+                }
                 template <class TLP, class TokenSpec, class Func>
-                static constexpr auto parse_left_impl(lex::detail::type_list<>,
-                                                      tokenizer<TokenSpec>&, Func&,
-                                                      op_parse_result<TLP, Func>& lhs)
+                static constexpr auto parse_no_left(tokenizer<TokenSpec>&, Func&,
+                                                    op_parse_result<TLP, Func>& lhs)
+                    -> op_parse_result<TLP, Func>
                 {
                     // no left operator found
                     return static_cast<op_parse_result<TLP, Func>&&>(lhs);
                 }
-                template <class TLP, class Head, class... Tail, class TokenSpec, class Func>
-                static constexpr auto parse_left_impl(lex::detail::type_list<Head, Tail...>,
-                                                      tokenizer<TokenSpec>& tokenizer, Func& f,
-                                                      op_parse_result<TLP, Func>& lhs)
+
+                template <class Head, class TLP, class TokenSpec, class Func>
+                static constexpr auto parse_child(tokenizer<TokenSpec>& tokenizer, Func& f)
+                    -> op_parse_result<TLP, Func>
                 {
-                    auto old    = tokenizer.current_ptr();
-                    auto result = Head::template parse_left<TLP>(tokenizer, f, lhs);
-                    if (tokenizer.current_ptr() != old)
-                        // Head parsed something, so we're done
-                        return result;
-                    else
-                        // try the next child
-                        return parse_left_impl<TLP>(lex::detail::type_list<Tail...>{}, tokenizer, f,
-                                                    lhs);
+                    // we have a prefix operator that definitely narrows it down to Head
+                    return engine_parser_for<TLP>::template parse<Head, TLP>(tokenizer, f);
                 }
-
                 template <class TLP, class TokenSpec, class Func>
-                static constexpr auto parse_impl(lex::detail::type_list<>,
-                                                 tokenizer<TokenSpec>& tokenizer, Func& f)
+                static constexpr auto parse_atom(tokenizer<TokenSpec>& tokenizer, Func& f)
+                    -> op_parse_result<TLP, Func>
                 {
                     // we haven't found any prefix operator, so parse an atom
-                    // then use the first child whose parse_left() function matched something
+                    // then use the first child whose parse_left() function matches the next token
 
                     // to parse an atom, we can just use the parse_null() function of any child,
                     // as we didn't have a prefix operator that would match
-                    auto atom = Child::template parse_null<TLP>(tokenizer, f);
-                    return parse_left_impl<TLP>(lex::detail::type_list<Child, Children...>{},
-                                                tokenizer, f, atom);
-                }
-                template <class TLP, class Head, class... Tail, class TokenSpec, class Func>
-                static constexpr auto parse_impl(lex::detail::type_list<Head, Tail...>,
-                                                 tokenizer<TokenSpec>& tokenizer, Func& f)
-                {
-                    if (operator_spelling<typename Head::pre_tokens>::match(tokenizer.peek()))
-                        // we have a prefix operator that definitely narrows it down to Head
-                        return detail::parse<Head, TLP>(tokenizer, f);
-                    else
-                        // try to parse the next one instead
-                        return parse_impl<TLP>(lex::detail::type_list<Tail...>{}, tokenizer, f);
+                    auto atom
+                        = engine_parser_for<TLP>::template parse_null<Child, TLP>(tokenizer, f);
+                    if (atom.is_unmatched())
+                        return atom;
+
+                    using parse_left_fn = op_parse_result<TLP, Func> (*)(
+                        lex::tokenizer<TokenSpec>&, Func&, op_parse_result<TLP, Func>&);
+                    // indexed by the child, the last one is for tokens that aren't left operators
+                    const parse_left_fn children[]
+                        = {&parse_left_child<Child, TLP, TokenSpec, Func>,
+                           &parse_left_child<Children, TLP, TokenSpec, Func>...,
+                           &parse_no_left<TLP, TokenSpec, Func>};
+
+                    auto child = left_table<TokenSpec>::lookup(tokenizer.peek());
+                    return children[child](tokenizer, f, atom);
                 }
 
                 template <class TLP, class TokenSpec, class Func>
                 static constexpr auto parse(tokenizer<TokenSpec>& tokenizer, Func& f)
+                    -> op_parse_result<TLP, Func>
                 {
-                    return parse_impl<TLP>(lex::detail::type_list<Child, Children...>{}, tokenizer,
-                                           f);
+                    using parse_fn
+                        = op_parse_result<TLP, Func> (*)(lex::tokenizer<TokenSpec>&, Func&);
+                    // indexed by the child, the last one is for tokens that aren't prefix operators
+                    const parse_fn children[] = {&parse_child<Child, TLP, TokenSpec, Func>,
+                                                 &parse_child<Children, TLP, TokenSpec, Func>...,
+                                                 &parse_atom<TLP, TokenSpec, Func>};
+
+                    auto child = prefix_table<TokenSpec>::lookup(tokenizer.peek());
+                    return children[child](tokenizer, f);
                 }
             };
 
@@ -782,7 +1307,7 @@ namespace lex
     } // namespace operator_rule
 
     template <class Derived, class Grammar>
-    class operator_production : public detail::base_production
+    class operator_production : public detail::memoizable_production<Derived, Grammar>
     {
         template <class Func>
         static constexpr auto parse_impl(int, tokenizer<typename Grammar::token_spec>& tokenizer,
@@ -803,6 +1328,8 @@ namespace lex
     public:
         using grammar = Grammar;
 
+        using detail::memoizable_production<Derived, Grammar>::parse;
+
         template <class Func>
         static constexpr auto parse(tokenizer<typename Grammar::token_spec>& tokenizer, Func&& f)
             -> decltype(parse_impl(0, tokenizer, f))
@@ -0,0 +1,146 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_PARALLEL_TOKENIZE_HPP_INCLUDED
+#define FOONATHAN_LEX_PARALLEL_TOKENIZE_HPP_INCLUDED
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <foonathan/lex/tokenizer.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace detail
+    {
+        // the tokens starting in [chunk_begin, chunk_end),
+        // when tokenizing as if the input started at chunk_begin
+        template <class TokenSpec>
+        struct speculative_chunk
+        {
+            std::vector<token<TokenSpec>> tokens;
+            // the start of the first token after the chunk
+            const char* exit;
+
+            void tokenize(const char* begin, const char* chunk_begin, const char* chunk_end,
+                          const char* end)
+            {
+                tokenizer<TokenSpec> tokenizer(begin, end);
+                tokenizer.reset(chunk_begin);
+                tokenize(tokenizer, chunk_end);
+            }
+
+            void tokenize(tokenizer<TokenSpec>& tokenizer, const char* chunk_end)
+            {
+                // skip leading whitespace, if we started in some
+                if (tokenizer.peek().template is_category<is_whitespace>())
+                    tokenizer.bump();
+
+                while (!tokenizer.is_done() && tokenizer.current_ptr() < chunk_end)
+                    tokens.push_back(tokenizer.get());
+                exit = tokenizer.current_ptr();
+            }
+
+            // returns the index of the token starting at ptr, or tokens.size()
+            std::size_t find(const char* ptr) const noexcept
+            {
+                auto iter = std::lower_bound(tokens.begin(), tokens.end(), ptr,
+                                             [](const token<TokenSpec>& token, const char* ptr) {
+                                                 return token.spelling().data() < ptr;
+                                             });
+                if (iter != tokens.end() && iter->spelling().data() == ptr)
+                    return static_cast<std::size_t>(iter - tokens.begin());
+                else
+                    return tokens.size();
+            }
+        };
+    } // namespace detail
+
+    /// Tokenizes the character range `[begin, end)` using multiple threads.
+    ///
+    /// The range is split into `threads` chunks of equal size and each one is tokenized
+    /// concurrently, as if the input would start at the beginning of the chunk.
+    /// As the guessed boundary might be inside a token, the chunks are then stitched together:
+    /// starting at the actual position of the first token of a chunk, it is tokenized sequentially
+    /// until a token starts at the same position as one of the speculatively created tokens,
+    /// from then on both agree.
+    /// Usually, the two agree after a couple of tokens already.
+    ///
+    /// \returns All tokens except the final EOF token,
+    /// exactly the ones that are returned by `get()` of a [lex::tokenizer]() of the same range.
+    /// \notes Each chunk should be big enough to make up for the overhead of starting a thread.
+    template <class TokenSpec>
+    std::vector<token<TokenSpec>> parallel_tokenize(const char* begin, const char* end,
+                                                    std::size_t threads)
+    {
+        auto size = static_cast<std::size_t>(end - begin);
+        if (threads > size)
+            threads = size;
+        if (threads == 0)
+            threads = 1;
+
+        std::vector<const char*> boundaries;
+        for (auto i = 0u; i != threads; ++i)
+            boundaries.push_back(begin + i * (size / threads));
+        boundaries.push_back(end);
+
+        // tokenize the chunks concurrently, the first one on this thread
+        std::vector<detail::speculative_chunk<TokenSpec>> chunks(threads);
+        {
+            std::vector<std::thread> workers;
+            for (auto i = 1u; i != threads; ++i)
+                workers.emplace_back([&, i] {
+                    chunks[i].tokenize(begin, boundaries[i], boundaries[i + 1], end);
+                });
+
+            tokenizer<TokenSpec> tokenizer(begin, end);
+            chunks[0].tokenize(tokenizer, boundaries[1]);
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        // stitch the chunks together
+        auto result = std::move(chunks[0].tokens);
+        auto ptr    = chunks[0].exit;
+        for (auto i = 1u; i != threads; ++i)
+        {
+            auto& chunk = chunks[i];
+            if (ptr >= boundaries[i + 1])
+                // a previous token extends past the chunk
+                continue;
+
+            tokenizer<TokenSpec> tokenizer(begin, end);
+            tokenizer.reset(ptr);
+            while (true)
+            {
+                auto index = chunk.find(tokenizer.current_ptr());
+                if (index != chunk.tokens.size())
+                {
+                    // resynchronized, take the rest of the chunk
+                    result.insert(result.end(), chunk.tokens.begin() + std::ptrdiff_t(index),
+                                  chunk.tokens.end());
+                    ptr = chunk.exit;
+                    break;
+                }
+                else if (tokenizer.is_done() || tokenizer.current_ptr() >= boundaries[i + 1])
+                {
+                    // didn't resynchronize in this chunk
+                    ptr = tokenizer.current_ptr();
+                    break;
+                }
+
+                result.push_back(tokenizer.get());
+            }
+        }
+
+        return result;
+    }
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_PARALLEL_TOKENIZE_HPP_INCLUDED
@@ -0,0 +1,295 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_PARSE_MEMO_HPP_INCLUDED
+#define FOONATHAN_LEX_PARSE_MEMO_HPP_INCLUDED
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <foonathan/lex/grammar.hpp>
+#include <foonathan/lex/parse_result.hpp>
+#include <foonathan/lex/parser.hpp>
+#include <foonathan/lex/production_kind.hpp>
+#include <foonathan/lex/retokenize.hpp>
+#include <foonathan/lex/tokenizer.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace detail
+    {
+        // a unique address for each type
+        template <typename T>
+        struct memo_type_tag
+        {
+            static constexpr char id = 0;
+        };
+        template <typename T>
+        constexpr char memo_type_tag<T>::id;
+
+        // stores a copy of the value of a parse result
+        template <typename T>
+        struct memo_value
+        {
+            using is_memoizable = std::is_copy_constructible<T>;
+
+            static std::shared_ptr<const void> store(const parse_result<T>& result)
+            {
+                return std::make_shared<T>(result.value());
+            }
+
+            static parse_result<T> load(const void* value)
+            {
+                return parse_result<T>::success(*static_cast<const T*>(value));
+            }
+        };
+        template <>
+        struct memo_value<void>
+        {
+            using is_memoizable = std::true_type;
+
+            static std::shared_ptr<const void> store(const parse_result<void>&)
+            {
+                return nullptr;
+            }
+
+            static parse_result<void> load(const void*)
+            {
+                return parse_result<void>::success();
+            }
+        };
+    } // namespace detail
+
+    /// The results of the productions of a previous parse,
+    /// so they can be reused after the input has been edited.
+    ///
+    /// Passing it to [lex::parse]() stores the result of every production that was parsed
+    /// successfully, keyed by its [lex::production_kind]() and the position of its first token.
+    /// After the input has been edited, call `apply()` with the edit:
+    /// the next parse then reuses the results of all productions the edit did not touch and only
+    /// parses the productions that cover it again.
+    ///
+    /// A production is unaffected if neither its tokens nor the token following it overlap the
+    /// edit, so this assumes that productions only look at a single token after their end.
+    /// Reused results are copies of the stored ones:
+    /// they must not refer to the old input, and the callbacks of the productions that created
+    /// them are not invoked again, including error callbacks.
+    /// Results that cannot be copied are never stored.
+    template <class Grammar>
+    class parse_memo
+    {
+    public:
+        /// \effects Creates an empty memo, the next parse has to parse everything.
+        parse_memo() = default;
+
+        /// \effects Updates the memo after the input has been edited:
+        /// results of productions that are affected by the edit are discarded,
+        /// the positions of the productions after it are shifted.
+        void apply(text_edit edit)
+        {
+            auto edit_end = edit.offset + edit.old_length;
+            auto end
+                = std::remove_if(entries_.begin(), entries_.end(), [&](const entry& e) {
+                      return e.lookahead_end >= edit.offset && e.begin < edit_end;
+                  });
+            entries_.erase(end, entries_.end());
+
+            for (auto& e : entries_)
+                if (e.begin >= edit_end)
+                {
+                    e.begin         = e.begin - edit.old_length + edit.new_length;
+                    e.end           = e.end - edit.old_length + edit.new_length;
+                    e.lookahead_end = e.lookahead_end - edit.old_length + edit.new_length;
+                }
+        }
+
+        /// \effects Discards all results.
+        void clear() noexcept
+        {
+            entries_.clear();
+            reused_ = 0;
+        }
+
+        /// \returns The number of results that are stored.
+        std::size_t size() const noexcept
+        {
+            return entries_.size();
+        }
+
+        /// \returns The number of results that have been reused by the last parse.
+        std::size_t reused() const noexcept
+        {
+            return reused_;
+        }
+
+    private:
+        struct entry
+        {
+            // offsets of the first token, one past the last token and one past the token after
+            std::size_t begin, end, lookahead_end;
+            std::size_t kind;
+            // the type of the result, as it depends on the callback
+            const void*                 type;
+            std::shared_ptr<const void> value;
+
+            friend bool operator<(const entry& lhs, const entry& rhs) noexcept
+            {
+                return lhs.begin < rhs.begin || (lhs.begin == rhs.begin && lhs.kind < rhs.kind);
+            }
+        };
+
+        const entry* find(std::size_t begin, std::size_t kind, const void* type) const noexcept
+        {
+            entry key{begin, 0, 0, kind, nullptr, nullptr};
+            auto  iter = std::lower_bound(entries_.begin(), entries_.end(), key);
+            if (iter != entries_.end() && iter->begin == begin && iter->kind == kind
+                && iter->type == type)
+                return &*iter;
+            else
+                return nullptr;
+        }
+
+        // merges the results of the last parse, they replace existing ones
+        void commit()
+        {
+            std::stable_sort(added_.begin(), added_.end());
+
+            std::vector<entry> result;
+            result.reserve(entries_.size() + added_.size());
+            std::merge(std::make_move_iterator(added_.begin()),
+                       std::make_move_iterator(added_.end()),
+                       std::make_move_iterator(entries_.begin()),
+                       std::make_move_iterator(entries_.end()), std::back_inserter(result));
+            auto end = std::unique(result.begin(), result.end(),
+                                   [](const entry& lhs, const entry& rhs) {
+                                       return !(lhs < rhs) && !(rhs < lhs);
+                                   });
+            result.erase(end, result.end());
+
+            entries_ = std::move(result);
+            added_.clear();
+        }
+
+        // sorted by begin and kind
+        std::vector<entry> entries_;
+        // the results stored by the current parse
+        std::vector<entry> added_;
+        std::size_t        reused_ = 0;
+
+        template <class G, class Func>
+        friend class detail::memo_callback;
+    };
+
+    namespace detail
+    {
+        // forwards to the actual callback,
+        // but the productions use it to reuse and store their results
+        template <class Grammar, class Func>
+        class memo_callback
+        {
+        public:
+            explicit memo_callback(Func& f, parse_memo<Grammar>& memo, const char* begin) noexcept
+            : f_(f), memo_(memo), begin_(begin)
+            {
+                memo_.reused_ = 0;
+            }
+
+            template <typename... Args>
+            constexpr auto operator()(Args&&... args) const
+                -> decltype(std::declval<Func&>()(static_cast<Args&&>(args)...))
+            {
+                return f_(static_cast<Args&&>(args)...);
+            }
+
+            // parses the production by invoking parse(), unless its result can be reused
+            template <class Production, class Parse>
+            auto memoize(tokenizer<typename Grammar::token_spec>& tokenizer, Parse parse)
+                -> decltype(parse())
+            {
+                using result_type = decltype(parse());
+                using value       = memo_value<typename result_type::value_type>;
+                using can_memoize
+                    = std::integral_constant<bool, contains<Grammar, Production>::value
+                                                       && value::is_memoizable::value>;
+                return memoize<Production>(can_memoize{}, tokenizer, parse);
+            }
+
+            void commit()
+            {
+                memo_.commit();
+            }
+
+        private:
+            template <class Production, class Parse>
+            auto memoize(std::false_type, tokenizer<typename Grammar::token_spec>&, Parse& parse)
+                -> decltype(parse())
+            {
+                return parse();
+            }
+
+            template <class Production, class Parse>
+            auto memoize(std::true_type, tokenizer<typename Grammar::token_spec>& tokenizer,
+                         Parse& parse) -> decltype(parse())
+            {
+                using result_type = decltype(parse());
+                using value       = memo_value<typename result_type::value_type>;
+
+                std::size_t kind  = production_kind<Grammar>::template of<Production>().get();
+                const void* type  = &memo_type_tag<result_type>::id;
+                auto        begin = offset(tokenizer.current_ptr());
+
+                if (auto entry = memo_.find(begin, kind, type))
+                {
+                    tokenizer.reset(begin_ + entry->end);
+                    ++memo_.reused_;
+                    return value::load(entry->value.get());
+                }
+
+                auto result = parse();
+                if (result.is_success())
+                {
+                    auto next = tokenizer.peek().spelling();
+                    memo_.added_.push_back({begin, offset(tokenizer.current_ptr()),
+                                            offset(next.end()), kind, type,
+                                            value::store(result)});
+                }
+                return result;
+            }
+
+            std::size_t offset(const char* ptr) const noexcept
+            {
+                return static_cast<std::size_t>(ptr - begin_);
+            }
+
+            Func&                f_;
+            parse_memo<Grammar>& memo_;
+            const char*          begin_;
+        };
+    } // namespace detail
+
+    /// Parses the grammar like the other overloads, but with a [lex::parse_memo]().
+    ///
+    /// \effects Reuses the results stored in the memo and stores the results of all productions
+    /// that are parsed.
+    /// \requires The memo must be empty or have been filled by parsing the same input,
+    /// and updated by `apply()` for every edit since then.
+    template <class Grammar, class Func>
+    auto parse(tokenizer<typename Grammar::token_spec>& tokenizer, Func&& f,
+               parse_memo<Grammar>& memo)
+    {
+        using callback_type = detail::memo_callback<Grammar, std::remove_reference_t<Func>>;
+        callback_type callback(f, memo, tokenizer.begin_ptr());
+        auto result = parse<Grammar>(tokenizer, callback);
+        callback.commit();
+        return result;
+    }
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_PARSE_MEMO_HPP_INCLUDED
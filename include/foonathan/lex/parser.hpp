@@ -33,12 +33,54 @@ namespace lex
         {
             return parse_token_impl<Token>(0, token);
         }
+
+        //=== extern parser ===//
+        template <class Func, typename = void>
+        struct callback_extern_parser : std::false_type
+        {};
+
+        template <class Func>
+        struct callback_extern_parser<Func, decltype(void(Func::extern_parser))>
+        : std::integral_constant<bool, Func::extern_parser>
+        {};
+
+        template <class Grammar, class Func, typename = void>
+        struct has_extern_parser : std::false_type
+        {};
+        template <class Grammar, class Func>
+        struct has_extern_parser<Grammar, Func,
+                                 decltype(void(foonathan_lex_extern_parse(
+                                     extern_tag<Grammar, Func>{},
+                                     std::declval<tokenizer<typename Grammar::token_spec>&>(),
+                                     std::declval<Func&>())))> : std::true_type
+        {};
+
+        template <class Grammar, class Func>
+        using extern_parse_result = parse_result<decltype(
+            std::declval<Func&>()(callback_result_of<typename Grammar::start>{}))>;
+
+        template <class Grammar, class Func>
+        constexpr auto parse_start(std::false_type,
+                                   tokenizer<typename Grammar::token_spec>& tokenizer, Func& f)
+        {
+            return Grammar::start::parse(tokenizer, f);
+        }
+        template <class Grammar, class Func>
+        constexpr auto parse_start(std::true_type,
+                                   tokenizer<typename Grammar::token_spec>& tokenizer, Func& f)
+        {
+            static_assert(has_extern_parser<Grammar, Func>::value,
+                          "visitor with extern_parser requires FOONATHAN_LEX_DECLARE_PARSER()");
+            // defined by FOONATHAN_LEX_DEFINE_PARSER(), so the parser isn't instantiated
+            return foonathan_lex_extern_parse(extern_tag<Grammar, Func>{}, tokenizer, f);
+        }
     } // namespace detail
 
     template <class Grammar, class Func>
     constexpr auto parse(tokenizer<typename Grammar::token_spec>& tokenizer, Func&& f)
     {
-        auto result = Grammar::start::parse(tokenizer, f);
+        using is_extern = detail::callback_extern_parser<std::remove_reference_t<Func>>;
+        auto result     = detail::parse_start<Grammar>(is_extern{}, tokenizer, f);
         if (result.is_success() && !tokenizer.is_done())
         {
             unexpected_token<Grammar, typename Grammar::start, eof_token>
@@ -61,6 +103,35 @@ namespace lex
         tokenizer<typename Grammar::token_spec> tok(begin, end);
         return parse<Grammar>(tok, static_cast<Func&&>(f));
     }
+
+    /// Declares the function that parses `Grammar` with the visitor `Func`,
+    /// defined in a single translation unit using [FOONATHAN_LEX_DEFINE_PARSER]().
+    ///
+    /// `Func` must have a member `static constexpr bool extern_parser = true;`
+    /// and provide a `callback_result_of` overload for the start production,
+    /// which determines the result type.
+    /// The macro must be used in the namespace of the grammar or the visitor,
+    /// e.g. right after the definition of the visitor,
+    /// and both arguments must be type names without commas.
+    /// Calls to [lex::parse]() with a visitor of type `Func` then call that function instead of
+    /// the parser of the start production, so other translation units don't have to instantiate
+    /// and compile the parser; parsing a grammar without the declaration is an error.
+    /// Use it together with [FOONATHAN_LEX_DECLARE_TOKENIZER]() for the token specification of the
+    /// grammar, and note that the parse can no longer be done in constant expressions.
+#define FOONATHAN_LEX_DECLARE_PARSER(Grammar, Func)                                                \
+    foonathan::lex::detail::extern_parse_result<Grammar, Func> foonathan_lex_extern_parse(         \
+        foonathan::lex::detail::extern_tag<Grammar, Func>,                                         \
+        foonathan::lex::tokenizer<typename Grammar::token_spec>& tokenizer, Func& f)
+
+    /// Defines the function declared by [FOONATHAN_LEX_DECLARE_PARSER]().
+    ///
+    /// It must be used in the same namespace in exactly one translation unit.
+#define FOONATHAN_LEX_DEFINE_PARSER(Grammar, Func)                                                 \
+    FOONATHAN_LEX_DECLARE_PARSER(Grammar, Func)                                                    \
+    {                                                                                              \
+        return Grammar::start::parse(tokenizer, f);                                                \
+    }                                                                                              \
+    static_assert(true, "")
 } // namespace lex
 } // namespace foonathan
 
@@ -0,0 +1,202 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_RETOKENIZE_HPP_INCLUDED
+#define FOONATHAN_LEX_RETOKENIZE_HPP_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+#include <foonathan/lex/tokenizer.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    /// An edit of a character range:
+    /// the `old_length` characters starting at `offset` have been replaced by `new_length`
+    /// characters.
+    struct text_edit
+    {
+        std::size_t offset;
+        std::size_t old_length;
+        std::size_t new_length;
+
+        /// \returns The difference in position of the characters after the edit.
+        constexpr std::ptrdiff_t shift() const noexcept
+        {
+            return static_cast<std::ptrdiff_t>(new_length)
+                   - static_cast<std::ptrdiff_t>(old_length);
+        }
+    };
+
+    namespace detail
+    {
+        // tokenizes like lex::tokenizer,
+        // but also records how many characters after each token its match has looked at
+        template <class TokenSpec>
+        struct tracking_tokenizer
+        {
+            using next_token = detail::next_token<TokenSpec, token_spec_inline_matcher<TokenSpec>>;
+
+            const char*             ptr;
+            const char*             end;
+            match_result<TokenSpec> result;
+            std::size_t             lookahead;
+
+            // matches the next non-whitespace token starting at the given position
+            void reset(const char* position) noexcept
+            {
+                ptr       = position;
+                auto last = position;
+                next_token::match(ptr, result, tracked_end(end, last));
+
+                // last is the furthest position looked at by the token or the whitespace before it,
+                // possibly end itself
+                auto token_end = ptr + result.bump;
+                lookahead
+                    = last < token_end ? 0u : static_cast<std::size_t>(last - token_end) + 1u;
+            }
+
+            token<TokenSpec> get() const noexcept
+            {
+                return token<TokenSpec>(result.kind, ptr, result.bump);
+            }
+        };
+    } // namespace detail
+
+    /// The tokens of a character range and their lookahead.
+    template <class TokenSpec>
+    struct tokenize_with_lookahead_result
+    {
+        /// The tokens, without the final EOF token.
+        std::vector<token<TokenSpec>> tokens;
+        /// The lookahead of each token.
+        std::vector<std::size_t> lookahead;
+    };
+
+    /// The tokens that have changed because of a [lex::text_edit]().
+    template <class TokenSpec>
+    struct retokenize_result
+    {
+        /// The old tokens in the range `[begin, end)` have to be replaced by `tokens`.
+        std::size_t begin, end;
+        /// The new tokens, they refer to the new character range.
+        std::vector<token<TokenSpec>> tokens;
+        /// The lookahead of each new token, it has to replace the old lookahead in the same way.
+        std::vector<std::size_t> lookahead;
+        /// The old tokens starting at `end` are unchanged,
+        /// but their position in the new character range differs by `shift` characters.
+        std::ptrdiff_t shift;
+    };
+
+    /// Tokenizes a character range, so it can be updated using [lex::retokenize]() later on.
+    ///
+    /// \returns The tokens of `[begin, end)`, exactly the ones returned by `get()` of a
+    /// [lex::tokenizer]() except the final EOF token.
+    /// For each token, it also returns its lookahead:
+    /// the number of characters after the token its match, or the match of the whitespace before
+    /// it, has looked at, counting the end of the range as a character.
+    template <class TokenSpec>
+    tokenize_with_lookahead_result<TokenSpec> tokenize_with_lookahead(const char* begin,
+                                                                      const char* end)
+    {
+        tokenize_with_lookahead_result<TokenSpec> result;
+
+        detail::tracking_tokenizer<TokenSpec> tokenizer{begin, end,
+                                                        match_result<TokenSpec>::unmatched(), 0};
+        for (tokenizer.reset(begin); !tokenizer.result.is_eof();
+             tokenizer.reset(tokenizer.ptr + tokenizer.result.bump))
+        {
+            result.tokens.push_back(tokenizer.get());
+            result.lookahead.push_back(tokenizer.lookahead);
+        }
+
+        return result;
+    }
+
+    /// Updates the tokens of a character range after it has been edited.
+    ///
+    /// `old_tokens` and `old_lookahead` are the tokens of the character range starting at
+    /// `old_begin` and their lookahead, as returned by [lex::tokenize_with_lookahead]() or a
+    /// previous call.
+    /// `[begin, end)` is the new character range, i.e. the old one after the edit has been applied.
+    /// The old character range does not need to be valid anymore,
+    /// the old tokens are only compared by position.
+    ///
+    /// A token whose match has only looked at characters before the edit is unchanged.
+    /// This includes the characters after the token itself, its lookahead,
+    /// so a token like `..` that could be continued by the edit or a comment that might be
+    /// terminated by it are tokenized again.
+    /// The new range is tokenized starting after the last of those unchanged tokens,
+    /// until a token starts at the same position, after shifting, as one of the old tokens after
+    /// the edit; from then on both agree.
+    /// If a rule token looks at characters before its beginning,
+    /// more tokens might have changed than are detected.
+    ///
+    /// \returns The range of old tokens that have changed and the new tokens replacing them.
+    template <class TokenSpec>
+    retokenize_result<TokenSpec> retokenize(const std::vector<token<TokenSpec>>& old_tokens,
+                                            const std::vector<std::size_t>&      old_lookahead,
+                                            const char* old_begin, const char* begin,
+                                            const char* end, text_edit edit)
+    {
+        FOONATHAN_LEX_PRECONDITION(old_tokens.size() == old_lookahead.size(),
+                                   "missing lookahead");
+        FOONATHAN_LEX_PRECONDITION(edit.offset + edit.new_length
+                                       <= static_cast<std::size_t>(end - begin),
+                                   "edit out of range");
+        auto old_offset = [&](std::size_t i) {
+            return static_cast<std::size_t>(old_tokens[i].spelling().data() - old_begin);
+        };
+        auto old_token_end = [&](std::size_t i) {
+            return old_offset(i) + old_tokens[i].spelling().size();
+        };
+
+        retokenize_result<TokenSpec> result{0, 0, {}, {}, edit.shift()};
+
+        // start at the first token whose match has looked at the edit,
+        // the ones before it are unchanged
+        while (result.begin != old_tokens.size()
+               && old_token_end(result.begin) + old_lookahead[result.begin] <= edit.offset)
+            ++result.begin;
+
+        // continue after the unchanged tokens, as the whitespace after them might have changed
+        detail::tracking_tokenizer<TokenSpec> tokenizer{begin, end,
+                                                        match_result<TokenSpec>::unmatched(), 0};
+        tokenizer.reset(result.begin == 0 ? begin : begin + old_token_end(result.begin - 1));
+
+        // the first old token that might be reused
+        auto old_end = edit.offset + edit.old_length;
+        result.end   = result.begin;
+        while (result.end != old_tokens.size() && old_offset(result.end) < old_end)
+            ++result.end;
+
+        while (!tokenizer.result.is_eof())
+        {
+            auto offset = static_cast<std::size_t>(tokenizer.ptr - begin);
+            while (result.end != old_tokens.size()
+                   && static_cast<std::ptrdiff_t>(old_offset(result.end)) + result.shift
+                          < static_cast<std::ptrdiff_t>(offset))
+                ++result.end;
+
+            if (result.end != old_tokens.size()
+                && static_cast<std::ptrdiff_t>(old_offset(result.end)) + result.shift
+                       == static_cast<std::ptrdiff_t>(offset))
+                // resynchronized, the remaining old tokens are unchanged
+                return result;
+
+            result.tokens.push_back(tokenizer.get());
+            result.lookahead.push_back(tokenizer.lookahead);
+            tokenizer.reset(tokenizer.ptr + tokenizer.result.bump);
+        }
+
+        // didn't resynchronize, all remaining old tokens are gone
+        result.end = old_tokens.size();
+        return result;
+    }
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_RETOKENIZE_HPP_INCLUDED
@@ -196,7 +196,7 @@ namespace lex
     } // namespace production_rule
 
     template <class Derived, class Grammar>
-    class rule_production : public detail::base_production
+    class rule_production : public detail::memoizable_production<Derived, Grammar>
     {
         template <class Func>
         static constexpr auto parse_impl(int, tokenizer<typename Grammar::token_spec>& tokenizer,
@@ -222,6 +222,8 @@ namespace lex
         }
 
     public:
+        using detail::memoizable_production<Derived, Grammar>::parse;
+
         template <class Func>
         static constexpr auto parse(tokenizer<typename Grammar::token_spec>& tokenizer, Func&& f)
             -> decltype(parse_impl(0, tokenizer, f))
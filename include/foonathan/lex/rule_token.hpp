@@ -5,6 +5,8 @@
 #ifndef FOONATHAN_LEX_RULE_TOKEN_HPP_INCLUDED
 #define FOONATHAN_LEX_RULE_TOKEN_HPP_INCLUDED
 
+#include <foonathan/lex/detail/char_class.hpp>
+#include <foonathan/lex/detail/tracked_end.hpp>
 #include <foonathan/lex/match_result.hpp>
 #include <foonathan/lex/token_spec.hpp>
 
@@ -37,6 +39,10 @@ namespace lex
     /// If it was an error, an error token is created.
     /// If it was a success, the correct token is created.
     ///
+    /// It must not look at characters after the ones it consumed and the one following them:
+    /// [lex::streaming_tokenizer]() and [lex::retokenize]() rely on it to decide whether a token
+    /// depends on characters that aren't available or have been changed.
+    ///
     /// It may create tokens of multiple other kinds if the parsing is related.
     /// The other tokens must then be [lex::null_token]() because they have no rules on their
     /// own.
@@ -128,7 +134,8 @@ namespace lex
 
                 constexpr char_(char c) noexcept : c(c) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     if (cur != end && *cur == c)
                     {
@@ -154,7 +161,8 @@ namespace lex
                 : str(str), length(length)
                 {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     if (starts_with(cur, end))
                     {
@@ -166,17 +174,14 @@ namespace lex
                 }
 
             private:
-                constexpr bool starts_with(const char* cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool starts_with(const char* cur, End end) const noexcept
                 {
-                    auto remaining = static_cast<std::size_t>(end - cur);
-                    if (remaining < length)
-                        return false;
-
                     auto str_cur = str;
                     auto str_end = str + length;
                     while (str_cur != str_end)
                     {
-                        if (*cur != *str_cur)
+                        if (cur == end || *cur != *str_cur)
                             return false;
                         ++cur;
                         ++str_cur;
@@ -202,7 +207,8 @@ namespace lex
 
                 constexpr ascii_predicate(Predicate p) noexcept : p(p) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     if (cur != end && p(*cur))
                     {
@@ -227,9 +233,13 @@ namespace lex
 
                 constexpr function(Function f) noexcept : func(f) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
-                    auto result = func(cur, end);
+                    // the function can only be given a pointer,
+                    // assume it has looked at the characters it consumed and the one after them
+                    auto result = func(cur, lex::detail::get_end(end));
+                    lex::detail::look_at(end, cur + result);
                     cur += result;
                     return result > 0u;
                 }
@@ -256,6 +266,8 @@ namespace lex
         /// * A callable with the signature `std::size_t(const char*, const char*)` which is invoked
         ///   with the current and end pointer, and returns the number of characters that are
         ///   consumed. The rule is considered matched if any characters are consumed.
+        ///   It must not look at characters after the ones it consumed and the one following
+        ///   them, like [lex::basic_rule_token]().
         ///
         /// For consistency, it can also be invoked passing it any other rule.
         /// Using this function is only necessary if an operator overload is used and neither
@@ -272,13 +284,18 @@ namespace lex
             template <std::size_t N>
             struct any : base_rule
             {
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
-                    auto remaining = end - cur;
-                    if (static_cast<std::size_t>(remaining) < N)
+                    auto remaining = static_cast<std::size_t>(lex::detail::get_end(end) - cur);
+                    if (remaining < N)
+                    {
+                        lex::detail::look_at(end, cur + remaining);
                         return false;
+                    }
                     else
                     {
+                        lex::detail::look_at(end, cur + N - 1);
                         cur += N;
                         return true;
                     }
@@ -299,7 +316,8 @@ namespace lex
         {
             struct eof : base_rule
             {
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     return cur == end;
                 }
@@ -313,7 +331,8 @@ namespace lex
         {
             struct fail : base_rule
             {
-                constexpr bool try_match(const char*&, const char*) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*&, End) const noexcept
                 {
                     return false;
                 }
@@ -334,7 +353,8 @@ namespace lex
 
                 constexpr sequence(R1 r1, R2 r2) noexcept : r1(r1), r2(r2) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     auto copy = cur;
 
@@ -373,7 +393,8 @@ namespace lex
 
                 constexpr choice(R1 r1, R2 r2) noexcept : r1(r1), r2(r2) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     if (r1.try_match(cur, end))
                         return true;
@@ -408,7 +429,8 @@ namespace lex
 
                 constexpr optional(R r) noexcept : r(r) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     r.try_match(cur, end);
                     return true;
@@ -435,7 +457,8 @@ namespace lex
 
                 constexpr zero_or_more(R r) noexcept : r(r) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     while (r.try_match(cur, end))
                     {
@@ -474,7 +497,8 @@ namespace lex
 
                 constexpr lookahead(R r) noexcept : r(r) {}
 
-                constexpr bool try_match(const char* const& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char* const& cur, End end) const noexcept
                 {
                     auto dummy = cur;
                     return r.try_match(dummy, end);
@@ -507,7 +531,8 @@ namespace lex
 
                 constexpr neg_lookahead(R r) noexcept : r(r) {}
 
-                constexpr bool try_match(const char* const& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char* const& cur, End end) const noexcept
                 {
                     auto dummy = cur;
                     return !r.try_match(dummy, end);
@@ -540,7 +565,8 @@ namespace lex
 
                 constexpr lookback(R r) noexcept : r(r) {}
 
-                constexpr bool try_match(const char* const& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char* const& cur, End end) const noexcept
                 {
                     auto dummy = cur - N;
                     return r.try_match(dummy, end);
@@ -559,7 +585,8 @@ namespace lex
 
                 constexpr rule_minus(Rule rule, Subtrahend sub) noexcept : rule(rule), sub(sub) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     auto copy = cur;
                     if (!rule.try_match(copy, end))
@@ -598,23 +625,130 @@ namespace lex
             return (r(condition) + then) / (!r(condition) + otherwise);
         }
 
+        namespace detail
+        {
+            // finds the first position where the rule matches
+            template <class End>
+            constexpr bool find(const char_& rule, const char*& cur, End end) noexcept
+            {
+                cur = lex::detail::find_char(cur, lex::detail::get_end(end), rule.c);
+                return cur != end;
+            }
+
+            template <class End>
+            constexpr bool find(const string& rule, const char*& cur, End end) noexcept
+            {
+                if (rule.length == 0)
+                    return true;
+
+                while (true)
+                {
+                    // search for the first character, then check the rest
+                    cur = lex::detail::find_char(cur, lex::detail::get_end(end), rule.str[0]);
+                    if (cur == end)
+                        return false;
+
+                    auto copy = cur;
+                    if (rule.try_match(copy, end))
+                        return true;
+                    ++cur;
+                }
+            }
+
+            // only used if the predicate isn't `constexpr`,
+            // otherwise the rule is compiled to a char_class_search
+            template <typename Predicate, class End>
+            constexpr bool find(const ascii_predicate<Predicate>& rule, const char*& cur,
+                                End end) noexcept
+            {
+                while (cur != end && !rule.p(*cur))
+                    ++cur;
+                return cur != end;
+            }
+
+            template <class Rule, class Until>
+            struct is_searchable : std::false_type
+            {};
+            template <>
+            struct is_searchable<char_, any<1>> : std::true_type
+            {};
+            template <>
+            struct is_searchable<string, any<1>> : std::true_type
+            {};
+            template <typename Predicate>
+            struct is_searchable<ascii_predicate<Predicate>, any<1>> : std::true_type
+            {};
+
+            // `until(end)` for an `end` that can be searched directly,
+            // instead of trying to match it at every position
+            template <class EndRule, bool Excluding>
+            struct until_search : base_rule
+            {
+                EndRule end_rule;
+
+                constexpr until_search(EndRule end) noexcept : end_rule(end) {}
+
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
+                {
+                    auto position = cur;
+                    if (!find(end_rule, position, end))
+                        return false;
+
+                    if (!Excluding)
+                        end_rule.try_match(position, end);
+                    cur = position;
+                    return true;
+                }
+            };
+
+            template <class End, class Until>
+            constexpr auto make_until(End end, Until until, std::false_type /* excluding */,
+                                      std::false_type /* searchable */) noexcept
+            {
+                return token_rule::star(!end + until) + end;
+            }
+            template <class End, class Until>
+            constexpr auto make_until(End end, Until until, std::true_type /* excluding */,
+                                      std::false_type /* searchable */) noexcept
+            {
+                return token_rule::star(!end + until) + token_rule::lookahead(end);
+            }
+            template <class End, class Until, bool Excluding>
+            constexpr auto make_until(End end, Until, std::integral_constant<bool, Excluding>,
+                                      std::true_type /* searchable */) noexcept
+            {
+                return until_search<End, Excluding>(end);
+            }
+        } // namespace detail
+
         /// Matches `until` until `end` is matched, then matches `end`.
         ///
         /// Equivalent to `star(!end + until) + end`.
+        /// If `until` is `any` and `end` is a character, string or predicate,
+        /// `end` is searched for directly instead.
         template <class End, class Until = detail::any<1>>
         constexpr auto until(End end, Until until = any) noexcept
         {
-            return star(!r(end) + until) + end;
+            using searchable
+                = detail::is_searchable<detail::rule_type<End>, detail::rule_type<Until>>;
+            return detail::make_until(detail::make_rule(end), detail::make_rule(until),
+                                      std::false_type{}, searchable{});
         }
 
         /// Matches `until` until `end` is matched, then does not match `end`.
         /// `end` must still follow aftwards, however.
         ///
         /// Equivalent to `star(!end + until) + lookahead(end)`.
+        /// If `until` is `any` and `end` is a character, string or predicate,
+        /// `end` is searched for directly instead.
         template <class End, class Until = detail::any<1>>
         constexpr auto until_excluding(End end, Until until = any) noexcept
         {
-            return star(!r(end) + until) + lookahead(end);
+            using searchable
+                = detail::is_searchable<detail::rule_type<End>, detail::rule_type<Until>>;
+            return detail::make_until(detail::make_rule(end), detail::make_rule(until),
+                                      std::true_type{}, searchable{});
         }
 
         /// Matches a non-empty list of `element`s separated by `separator`.
@@ -665,7 +799,8 @@ namespace lex
 
                 constexpr repeated(Rule rule) noexcept : rule(rule) {}
 
-                constexpr bool try_match(const char*& cur, const char* end) const noexcept
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
                 {
                     auto copy = cur;
 
@@ -729,15 +864,565 @@ namespace lex
         {
             return repeated<N, std::size_t(-1)>(rule);
         }
+
+        //=== character classes ===//
+        namespace detail
+        {
+            // matches a character of the class with a single table lookup
+            struct char_class_rule : base_rule
+            {
+                lex::detail::char_class cls;
+
+                constexpr char_class_rule(const lex::detail::char_class& cls) noexcept : cls(cls)
+                {}
+
+                constexpr bool contains(char c) const noexcept
+                {
+                    return cls.contains[static_cast<unsigned char>(c)];
+                }
+
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
+                {
+                    if (cur != end && contains(*cur))
+                    {
+                        ++cur;
+                        return true;
+                    }
+                    else
+                        return false;
+                }
+            };
+
+            // `star()` of a char_class_rule, skips vectorized
+            struct char_class_star : base_rule
+            {
+                char_class_rule r;
+
+                constexpr char_class_star(char_class_rule r) noexcept : r(r) {}
+
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
+                {
+                    cur = lex::detail::skip_char_class(r.cls, cur, lex::detail::get_end(end));
+                    lex::detail::look_at(end, cur);
+                    return true;
+                }
+            };
+
+            // `run()` of a char_class_rule, skips vectorized
+            struct char_class_run : base_rule
+            {
+                char_class_rule r;
+
+                constexpr char_class_run(char_class_rule r) noexcept : r(r) {}
+
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
+                {
+                    auto begin = cur;
+                    cur = lex::detail::skip_char_class(r.cls, cur, lex::detail::get_end(end));
+                    lex::detail::look_at(end, cur);
+                    return cur != begin;
+                }
+            };
+
+            // a char_class_rule that is searched for by skipping its complement vectorized
+            struct char_class_search : char_class_rule
+            {
+                lex::detail::char_class complement;
+
+                constexpr char_class_search(const char_class_rule& rule) noexcept
+                : char_class_rule(rule), complement(lex::detail::char_class_complement(rule.cls))
+                {}
+            };
+
+            template <class End>
+            constexpr bool find(const char_class_search& rule, const char*& cur, End end) noexcept
+            {
+                cur = lex::detail::skip_char_class(rule.complement, cur, lex::detail::get_end(end));
+                return cur != end;
+            }
+
+            // the rule `until_search` searches for
+            template <class Rule>
+            constexpr Rule make_search_rule(Rule rule) noexcept
+            {
+                return rule;
+            }
+            constexpr char_class_search make_search_rule(char_class_rule rule) noexcept
+            {
+                return rule;
+            }
+
+            // whether the rule consumes exactly one character of a fixed set
+            template <class Rule>
+            struct is_char_class : std::false_type
+            {};
+            template <>
+            struct is_char_class<char_> : std::true_type
+            {};
+            template <typename Predicate>
+            struct is_char_class<ascii_predicate<Predicate>> : std::true_type
+            {};
+            template <>
+            struct is_char_class<char_class_rule> : std::true_type
+            {};
+            template <class R1, class R2>
+            struct is_char_class<choice<R1, R2>>
+            : std::integral_constant<bool, is_char_class<R1>::value && is_char_class<R2>::value>
+            {};
+
+            constexpr lex::detail::char_class to_char_class(char_ rule) noexcept
+            {
+                return lex::detail::make_char_class(rule.c);
+            }
+            template <typename Predicate>
+            constexpr lex::detail::char_class to_char_class(
+                ascii_predicate<Predicate> rule) noexcept
+            {
+                return lex::detail::make_char_class(rule.p);
+            }
+            constexpr lex::detail::char_class to_char_class(char_class_rule rule) noexcept
+            {
+                return rule.cls;
+            }
+            template <class R1, class R2>
+            constexpr lex::detail::char_class to_char_class(choice<R1, R2> rule) noexcept
+            {
+                return lex::detail::char_class_union(to_char_class(rule.r1),
+                                                     to_char_class(rule.r2));
+            }
+
+            template <class R>
+            struct run : base_rule
+            {
+                static_assert(is_char_class<R>::value,
+                              "run() requires a character, predicate or choice of those");
+
+                R r;
+
+                constexpr run(R r) noexcept : r(r) {}
+
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
+                {
+                    if (!r.try_match(cur, end))
+                        return false;
+
+                    while (r.try_match(cur, end))
+                    {
+                    }
+                    return true;
+                }
+            };
+        } // namespace detail
+
+        /// Matches the longest non-empty sequence of characters in a character class.
+        ///
+        /// The class `r` is either a character, a predicate or a choice of those.
+        /// Equivalent to `plus(r)`, but if the rule of the token can be evaluated at compile-time,
+        /// it classifies 16 or 32 characters at once using vector instructions.
+        /// `star()` and `plus()` of a character class are matched that way as well.
+        template <class R>
+        constexpr auto run(R r) noexcept
+        {
+            return detail::run<detail::rule_type<R>>{detail::make_rule(r)};
+        }
+
+        //=== compilation ===//
+        namespace detail
+        {
+            // rewrites a rule into an equivalent one that is faster to match:
+            // predicates, and choices of predicates and characters, become table lookups
+            template <class Rule, typename = void>
+            struct rule_compiler
+            {
+                using type = Rule;
+
+                static constexpr type compile(Rule rule) noexcept
+                {
+                    return rule;
+                }
+            };
+
+            template <class Rule>
+            using compiled_rule_type = typename rule_compiler<Rule>::type;
+
+            template <class Rule>
+            constexpr compiled_rule_type<Rule> compile_rule(Rule rule) noexcept
+            {
+                return rule_compiler<Rule>::compile(rule);
+            }
+
+            template <typename Predicate>
+            struct rule_compiler<ascii_predicate<Predicate>>
+            {
+                using type = char_class_rule;
+
+                static constexpr type compile(ascii_predicate<Predicate> rule) noexcept
+                {
+                    return to_char_class(rule);
+                }
+            };
+
+            template <class R1, class R2>
+            struct rule_compiler<choice<R1, R2>,
+                                 std::enable_if_t<is_char_class<choice<R1, R2>>::value>>
+            {
+                using type = char_class_rule;
+
+                static constexpr type compile(choice<R1, R2> rule) noexcept
+                {
+                    return to_char_class(rule);
+                }
+            };
+
+            template <class R1, class R2>
+            struct rule_compiler<choice<R1, R2>,
+                                 std::enable_if_t<!is_char_class<choice<R1, R2>>::value>>
+            {
+                using type = choice<compiled_rule_type<R1>, compiled_rule_type<R2>>;
+
+                static constexpr type compile(choice<R1, R2> rule) noexcept
+                {
+                    return {compile_rule(rule.r1), compile_rule(rule.r2)};
+                }
+            };
+
+            template <class R>
+            struct rule_compiler<zero_or_more<R>, std::enable_if_t<is_char_class<R>::value>>
+            {
+                using type = char_class_star;
+
+                static constexpr type compile(zero_or_more<R> rule) noexcept
+                {
+                    return char_class_rule(to_char_class(rule.r));
+                }
+            };
+
+            template <class R>
+            struct rule_compiler<zero_or_more<R>, std::enable_if_t<!is_char_class<R>::value>>
+            {
+                using type = zero_or_more<compiled_rule_type<R>>;
+
+                static constexpr type compile(zero_or_more<R> rule) noexcept
+                {
+                    return compile_rule(rule.r);
+                }
+            };
+
+            template <class R>
+            struct rule_compiler<run<R>>
+            {
+                using type = char_class_run;
+
+                static constexpr type compile(run<R> rule) noexcept
+                {
+                    return char_class_rule(to_char_class(rule.r));
+                }
+            };
+
+            template <class R1, class R2>
+            struct rule_compiler<sequence<R1, R2>>
+            {
+                using type = sequence<compiled_rule_type<R1>, compiled_rule_type<R2>>;
+
+                static constexpr type compile(sequence<R1, R2> rule) noexcept
+                {
+                    return {compile_rule(rule.r1), compile_rule(rule.r2)};
+                }
+            };
+
+            template <class Rule, class Subtrahend>
+            struct rule_compiler<rule_minus<Rule, Subtrahend>>
+            {
+                using type = rule_minus<compiled_rule_type<Rule>, compiled_rule_type<Subtrahend>>;
+
+                static constexpr type compile(rule_minus<Rule, Subtrahend> rule) noexcept
+                {
+                    return {compile_rule(rule.rule), compile_rule(rule.sub)};
+                }
+            };
+
+            template <template <class> class Combinator, class R>
+            struct unary_rule_compiler
+            {
+                using type = Combinator<compiled_rule_type<R>>;
+
+                static constexpr type compile(Combinator<R> rule) noexcept
+                {
+                    return compile_rule(rule.r);
+                }
+            };
+
+            template <class R>
+            struct rule_compiler<optional<R>> : unary_rule_compiler<optional, R>
+            {};
+            template <class R>
+            struct rule_compiler<lookahead<R>>
+            : unary_rule_compiler<token_rule::detail::lookahead, R>
+            {};
+            template <class R>
+            struct rule_compiler<neg_lookahead<R>>
+            : unary_rule_compiler<token_rule::detail::neg_lookahead, R>
+            {};
+
+            template <class R, std::size_t N>
+            struct rule_compiler<lookback<R, N>>
+            {
+                using type = lookback<compiled_rule_type<R>, N>;
+
+                static constexpr type compile(lookback<R, N> rule) noexcept
+                {
+                    return compile_rule(rule.r);
+                }
+            };
+
+            template <std::size_t Min, std::size_t Max, class Rule>
+            struct rule_compiler<repeated<Min, Max, Rule>>
+            {
+                using type = repeated<Min, Max, compiled_rule_type<Rule>>;
+
+                static constexpr type compile(repeated<Min, Max, Rule> rule) noexcept
+                {
+                    return compile_rule(rule.rule);
+                }
+            };
+
+            template <class End, bool Excluding>
+            struct rule_compiler<until_search<End, Excluding>>
+            {
+                using type = until_search<
+                    decltype(make_search_rule(std::declval<compiled_rule_type<End>>())), Excluding>;
+
+                static constexpr type compile(until_search<End, Excluding> rule) noexcept
+                {
+                    return make_search_rule(compile_rule(rule.end_rule));
+                }
+            };
+
+            template <class Token, typename = void>
+            struct is_compile_time_rule : std::false_type
+            {};
+            template <class Token>
+            using compile_time_rule_check = std::integral_constant<
+                bool, (compile_rule(make_rule(Token::rule())), true)>;
+
+            template <class Token>
+            struct is_compile_time_rule<Token, decltype(void(compile_time_rule_check<Token>{}))>
+            : std::true_type
+            {};
+
+            // the compiled rule of a token, stored once
+            //
+            // If the rule can't be compiled at compile-time,
+            // e.g. because a predicate isn't `constexpr`, it is used as-is.
+            template <class Token, bool Compile = is_compile_time_rule<Token>::value>
+            struct token_rule_storage
+            {
+                using type = rule_type<decltype(Token::rule())>;
+
+                static constexpr type value = make_rule(Token::rule());
+            };
+
+            template <class Token>
+            struct token_rule_storage<Token, true>
+            {
+                using type = compiled_rule_type<rule_type<decltype(Token::rule())>>;
+
+                static constexpr type value = compile_rule(make_rule(Token::rule()));
+            };
+
+            template <class Token, bool Compile>
+            constexpr typename token_rule_storage<Token, Compile>::type
+                token_rule_storage<Token, Compile>::value;
+            template <class Token>
+            constexpr typename token_rule_storage<Token, true>::type
+                token_rule_storage<Token, true>::value;
+
+            // refers to the stored rule, so the tables aren't copied around
+            template <class Token>
+            struct compiled_token_rule : base_rule
+            {
+                template <class End>
+                constexpr bool try_match(const char*& cur, End end) const noexcept
+                {
+                    return token_rule_storage<Token>::value.try_match(cur, end);
+                }
+            };
+        } // namespace detail
+
+        //=== FIRST sets ===//
+        namespace detail
+        {
+            // the characters a rule can start with, and whether it can match without consuming any
+            struct first_set
+            {
+                bool contains[256];
+                bool is_nullable;
+            };
+
+            constexpr first_set make_first_set(bool all, bool is_nullable) noexcept
+            {
+                first_set result{};
+                for (auto i = 0u; i != 256u; ++i)
+                    result.contains[i] = all;
+                result.is_nullable = is_nullable;
+                return result;
+            }
+
+            constexpr first_set make_first_set(const lex::detail::char_class& cls,
+                                               bool                           is_nullable) noexcept
+            {
+                first_set result{};
+                for (auto i = 0u; i != 256u; ++i)
+                    result.contains[i] = cls.contains[i];
+                result.is_nullable = is_nullable;
+                return result;
+            }
+
+            constexpr first_set first_set_union(const first_set& lhs, const first_set& rhs,
+                                                bool is_nullable) noexcept
+            {
+                first_set result{};
+                for (auto i = 0u; i != 256u; ++i)
+                    result.contains[i] = lhs.contains[i] || rhs.contains[i];
+                result.is_nullable = is_nullable;
+                return result;
+            }
+
+            // unknown rules can start with anything
+            template <class Rule>
+            constexpr first_set get_first_set(const Rule&) noexcept
+            {
+                return make_first_set(true, true);
+            }
+
+            constexpr first_set get_first_set(const char_& rule) noexcept
+            {
+                return make_first_set(lex::detail::make_char_class(rule.c), false);
+            }
+            constexpr first_set get_first_set(const string& rule) noexcept
+            {
+                if (rule.length == 0)
+                    return make_first_set(false, true);
+                else
+                    return make_first_set(lex::detail::make_char_class(rule.str[0]), false);
+            }
+            template <typename Predicate>
+            constexpr first_set get_first_set(const ascii_predicate<Predicate>& rule) noexcept
+            {
+                return make_first_set(to_char_class(rule), false);
+            }
+            template <std::size_t N>
+            constexpr first_set get_first_set(const any<N>&) noexcept
+            {
+                return make_first_set(N > 0, N == 0);
+            }
+            constexpr first_set get_first_set(const eof&) noexcept
+            {
+                return make_first_set(false, true);
+            }
+            constexpr first_set get_first_set(const fail&) noexcept
+            {
+                return make_first_set(false, false);
+            }
+
+            template <class R1, class R2>
+            constexpr first_set get_first_set(const sequence<R1, R2>& rule) noexcept
+            {
+                auto first = get_first_set(rule.r1);
+                if (!first.is_nullable)
+                    return first;
+
+                auto second = get_first_set(rule.r2);
+                return first_set_union(first, second, second.is_nullable);
+            }
+            template <class R1, class R2>
+            constexpr first_set get_first_set(const choice<R1, R2>& rule) noexcept
+            {
+                auto first  = get_first_set(rule.r1);
+                auto second = get_first_set(rule.r2);
+                return first_set_union(first, second, first.is_nullable || second.is_nullable);
+            }
+            template <class R>
+            constexpr first_set get_first_set(const optional<R>& rule) noexcept
+            {
+                auto result        = get_first_set(rule.r);
+                result.is_nullable = true;
+                return result;
+            }
+            template <class R>
+            constexpr first_set get_first_set(const zero_or_more<R>& rule) noexcept
+            {
+                auto result        = get_first_set(rule.r);
+                result.is_nullable = true;
+                return result;
+            }
+            template <class R>
+            constexpr first_set get_first_set(const run<R>& rule) noexcept
+            {
+                return get_first_set(rule.r);
+            }
+            template <std::size_t Min, std::size_t Max, class Rule>
+            constexpr first_set get_first_set(const repeated<Min, Max, Rule>& rule) noexcept
+            {
+                auto result = get_first_set(rule.rule);
+                result.is_nullable |= Min == 0;
+                return result;
+            }
+            template <class Rule, class Subtrahend>
+            constexpr first_set get_first_set(const rule_minus<Rule, Subtrahend>& rule) noexcept
+            {
+                return get_first_set(rule.rule);
+            }
+
+            // rules that don't consume anything
+            template <class R>
+            constexpr first_set get_first_set(const lookahead<R>&) noexcept
+            {
+                return make_first_set(false, true);
+            }
+            template <class R>
+            constexpr first_set get_first_set(const neg_lookahead<R>&) noexcept
+            {
+                return make_first_set(false, true);
+            }
+            template <class R, std::size_t N>
+            constexpr first_set get_first_set(const lookback<R, N>&) noexcept
+            {
+                return make_first_set(false, true);
+            }
+
+            constexpr first_set get_first_set(const char_class_rule& rule) noexcept
+            {
+                return make_first_set(rule.cls, false);
+            }
+            constexpr first_set get_first_set(const char_class_star& rule) noexcept
+            {
+                return make_first_set(rule.r.cls, true);
+            }
+            constexpr first_set get_first_set(const char_class_run& rule) noexcept
+            {
+                return make_first_set(rule.r.cls, false);
+            }
+
+            template <class Token>
+            constexpr first_set get_first_set(const compiled_token_rule<Token>&) noexcept
+            {
+                return get_first_set(token_rule_storage<Token>::value);
+            }
+        } // namespace detail
     } // namespace token_rule
 
     /// Matches a [lex::token_rule]().
-    template <class TokenSpec>
+    template <class TokenSpec, class End = const char*>
     class rule_matcher
     {
     public:
         /// \effects Creates it passing it the string to be matched.
-        explicit constexpr rule_matcher(const char* str, const char* end) noexcept
+        explicit constexpr rule_matcher(const char* str, End end) noexcept
         : begin_(str), cur_(str), end_(end)
         {}
 
@@ -783,7 +1468,7 @@ namespace lex
 
         const char* begin_;
         const char* cur_;
-        const char* end_;
+        End         end_;
     };
 
     /// A token that follows a PEG parsing rule.
@@ -791,14 +1476,17 @@ namespace lex
     /// It must provide a function `static constexpr auto rule()` which returns a
     /// [lex::token_rule]() object. It matches a token if the rule matches a non-zero amount of
     /// characters.
+    ///
+    /// If the rule can be evaluated at compile-time, predicates and choices of predicates and
+    /// characters are turned into lookup tables, so matching them is a single load per character.
     template <class Derived, class TokenSpec>
     struct rule_token : basic_rule_token<Derived, TokenSpec>
     {
-        static constexpr lex::match_result<TokenSpec> try_match(const char* str,
-                                                                const char* end) noexcept
+        template <class End>
+        static constexpr lex::match_result<TokenSpec> try_match(const char* str, End end) noexcept
         {
-            constexpr auto rule = Derived::rule();
-            return rule_matcher<TokenSpec>(str, end).finish(Derived{}, rule);
+            using rule = token_rule::detail::compiled_token_rule<Derived>;
+            return rule_matcher<TokenSpec, End>(str, end).finish(Derived{}, rule{});
         }
     };
 } // namespace lex
@@ -0,0 +1,246 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_STREAMING_TOKENIZER_HPP_INCLUDED
+#define FOONATHAN_LEX_STREAMING_TOKENIZER_HPP_INCLUDED
+
+#include <string>
+
+#include <foonathan/lex/tokenizer.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    /// Tokenizes a character range that is given in multiple chunks.
+    ///
+    /// It behaves like [lex::tokenizer]() on the concatenation of all chunks,
+    /// but only requires one chunk to be in memory at a time.
+    ///
+    /// A token whose match has looked at the end of a chunk might continue in the next one,
+    /// or a different token might match once more characters are available,
+    /// so it is not reported until the next chunk is available.
+    /// Instead the unfinished characters are copied and matched again once the next chunk is given.
+    /// The spelling of a token refers to the chunk the token is in,
+    /// and stays valid until the chunk is released by the user.
+    /// If it crosses a chunk boundary, it refers to an internal buffer instead,
+    /// which stays valid until the next call to `feed()` or `finish()`.
+    ///
+    /// Chunks are provided in a loop:
+    /// Once `needs_input()` returns `true`, the current chunk can be released and the next one
+    /// must be given by calling `feed()`, or `finish()` if there is no more input.
+    template <class TokenSpec>
+    class streaming_tokenizer
+    {
+        // needs to know how far the match has looked, so always uses the inline matcher
+        using next_token
+            = detail::next_token<TokenSpec, detail::token_spec_inline_matcher<TokenSpec>>;
+
+    public:
+        /// \effects Creates a tokenizer that does not have any input yet.
+        streaming_tokenizer() noexcept
+        : chunk_begin_(nullptr),
+          chunk_end_(nullptr),
+          ptr_(nullptr),
+          end_(nullptr),
+          prefix_size_(0),
+          appended_size_(0),
+          last_result_(match_result<TokenSpec>::unmatched()),
+          in_carry_(false),
+          needs_input_(true),
+          finished_(false)
+        {}
+
+        //=== input ===//
+        /// \returns Whether or not the next chunk must be given before the next token is
+        /// available.
+        bool needs_input() const noexcept
+        {
+            return needs_input_;
+        }
+
+        /// \effects Gives the next chunk `[begin, end)` of the input.
+        /// It must stay valid as long as tokens referring to it are used.
+        /// \requires `needs_input() == true` and `finish()` has not been called.
+        void feed(const char* begin, const char* end)
+        {
+            FOONATHAN_LEX_PRECONDITION(needs_input_ && !finished_, "tokenizer does not need input");
+            chunk_begin_ = begin;
+            chunk_end_   = end;
+            needs_input_ = false;
+
+            if (pending_.empty())
+            {
+                in_carry_ = false;
+                ptr_      = begin;
+                end_      = end;
+            }
+            else
+            {
+                // continue the unfinished token with the beginning of the chunk
+                carry_.swap(pending_);
+                pending_.clear();
+
+                prefix_size_   = carry_.size();
+                appended_size_ = 0;
+                carry_.reserve(prefix_size_ + static_cast<std::size_t>(end - begin));
+                in_carry_ = true;
+                ptr_      = carry_.data();
+                end_      = ptr_ + carry_.size();
+                append_chunk();
+            }
+
+            match();
+        }
+
+        /// \effects Same as `feed(ptr, ptr + size)`.
+        void feed(const char* ptr, std::size_t size)
+        {
+            feed(ptr, ptr + size);
+        }
+
+        /// \effects Signals that there is no more input after the current chunk.
+        /// \requires `needs_input() == true` and `finish()` has not been called.
+        void finish()
+        {
+            FOONATHAN_LEX_PRECONDITION(needs_input_ && !finished_, "tokenizer does not need input");
+            chunk_begin_ = nullptr;
+            chunk_end_   = nullptr;
+            needs_input_ = false;
+            finished_    = true;
+
+            carry_.swap(pending_);
+            pending_.clear();
+            prefix_size_   = carry_.size();
+            appended_size_ = 0;
+            in_carry_      = true;
+            ptr_           = carry_.data();
+            end_           = ptr_ + carry_.size();
+
+            match();
+        }
+
+        //=== tokenizer functions ===//
+        /// \returns The current token.
+        /// \requires `needs_input() == false`.
+        token<TokenSpec> peek() const noexcept
+        {
+            FOONATHAN_LEX_PRECONDITION(!needs_input_, "tokenizer needs input");
+            return token<TokenSpec>(last_result_.kind, ptr_, last_result_.bump);
+        }
+
+        /// \returns Whether or not EOF was reached, i.e. all input has been tokenized and
+        /// `finish()` has been called.
+        bool is_done() const noexcept
+        {
+            return finished_ && !needs_input_ && last_result_.is_eof();
+        }
+
+        /// Returns and advances the token.
+        /// \effects Consumes the current token by calling `bump()`.
+        /// \returns The current token, before it was consumed.
+        /// \requires `needs_input() == false`.
+        token<TokenSpec> get()
+        {
+            auto result = peek();
+            bump();
+            return result;
+        }
+
+        /// \effects Consumes the current token, `peek()` will then return the next token,
+        /// unless `needs_input()` returns `true` afterwards.
+        /// \requires `needs_input() == false`.
+        void bump()
+        {
+            FOONATHAN_LEX_PRECONDITION(!needs_input_, "tokenizer needs input");
+            if (is_done())
+                return;
+
+            ptr_ += last_result_.bump;
+            match();
+        }
+
+    private:
+        // appends more characters of the chunk to the carried characters,
+        // doubling the amount each time
+        void append_chunk()
+        {
+            auto remaining = static_cast<std::size_t>(chunk_end_ - chunk_begin_) - appended_size_;
+            auto size      = appended_size_ < 64u ? 64u : appended_size_;
+            if (size > remaining)
+                size = remaining;
+
+            // doesn't reallocate, so pointers stay valid
+            carry_.append(chunk_begin_ + appended_size_, size);
+            appended_size_ += size;
+            end_ = carry_.data() + carry_.size();
+        }
+
+        bool has_unappended_chunk() const noexcept
+        {
+            return appended_size_ != static_cast<std::size_t>(chunk_end_ - chunk_begin_);
+        }
+
+        void match()
+        {
+            while (true)
+            {
+                if (in_carry_ && has_unappended_chunk()
+                    && static_cast<std::size_t>(ptr_ - carry_.data()) >= prefix_size_)
+                {
+                    // the unfinished token is done, continue in the chunk itself
+                    ptr_      = chunk_begin_ + (static_cast<std::size_t>(ptr_ - carry_.data())
+                                           - prefix_size_);
+                    end_      = chunk_end_;
+                    in_carry_ = false;
+                }
+
+                auto last = ptr_;
+                auto skip
+                    = next_token::match_one(ptr_, last_result_, detail::tracked_end(end_, last));
+
+                if (!finished_ && last == end_)
+                {
+                    // the match depends on the characters after the available ones
+                    if (in_carry_ && has_unappended_chunk())
+                    {
+                        append_chunk();
+                        continue;
+                    }
+
+                    pending_.assign(ptr_, end_);
+                    needs_input_ = true;
+                    return;
+                }
+                else if (skip)
+                    ptr_ += last_result_.bump;
+                else
+                    return;
+            }
+        }
+
+        const char* chunk_begin_;
+        const char* chunk_end_;
+
+        const char* ptr_;
+        const char* end_;
+
+        // if in_carry_: [ptr_, end_) is in carry_,
+        // which consists of the unfinished token of the previous chunk (prefix_size_ characters),
+        // followed by appended_size_ characters of the current chunk
+        std::string carry_;
+        std::string pending_;
+        std::size_t prefix_size_;
+        std::size_t appended_size_;
+
+        match_result<TokenSpec> last_result_;
+
+        bool in_carry_;
+        bool needs_input_;
+        bool finished_;
+    };
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_STREAMING_TOKENIZER_HPP_INCLUDED
@@ -14,6 +14,16 @@ namespace lex
 {
     template <class TokenSpec>
     class tokenizer;
+    template <class TokenSpec>
+    class token_buffer;
+    template <class TokenSpec>
+    class streaming_tokenizer;
+
+    namespace detail
+    {
+        template <class TokenSpec>
+        struct tracking_tokenizer;
+    } // namespace detail
 
     /// A single token.
     ///
@@ -80,6 +90,9 @@ namespace lex
         token_kind<TokenSpec> kind_;
 
         friend tokenizer<TokenSpec>;
+        friend token_buffer<TokenSpec>;
+        friend streaming_tokenizer<TokenSpec>;
+        friend detail::tracking_tokenizer<TokenSpec>;
     };
 
     /// A single token whose kind is statically know and which can have an optional payload.
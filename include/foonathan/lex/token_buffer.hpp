@@ -0,0 +1,200 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_TOKEN_BUFFER_HPP_INCLUDED
+#define FOONATHAN_LEX_TOKEN_BUFFER_HPP_INCLUDED
+
+#include <foonathan/lex/tokenizer.hpp>
+
+namespace foonathan
+{
+namespace lex
+{
+    namespace detail
+    {
+        template <class TokenSpec>
+        struct bulk_tokenizer
+        {
+            const char*             ptr;
+            const char*             end;
+            match_result<TokenSpec> result;
+
+            // matches the next non-whitespace token starting at the given position
+            constexpr void reset(const char* position) noexcept
+            {
+                ptr = position;
+                next_token<TokenSpec>::match(ptr, result, end);
+            }
+
+            // stores at most `n` tokens, stops before EOF
+            constexpr std::size_t fill(const char* begin, token_kind<TokenSpec>* kinds,
+                                       std::size_t* offsets, std::size_t* lengths,
+                                       std::size_t n) noexcept
+            {
+                auto count = std::size_t(0);
+                while (count != n && !result.is_eof())
+                {
+                    kinds[count]   = result.kind;
+                    offsets[count] = static_cast<std::size_t>(ptr - begin);
+                    lengths[count] = result.bump;
+                    ++count;
+
+                    reset(ptr + result.bump);
+                }
+                return count;
+            }
+        };
+    } // namespace detail
+
+    /// A buffer of tokens stored as a structure of arrays.
+    ///
+    /// The kinds, offsets and lengths of the tokens are stored in three separate arrays provided by
+    /// the user, so passes that only look at the kinds can scan them without touching the rest.
+    /// The offsets are relative to `begin_ptr()`, the beginning of the tokenized character range.
+    /// Whitespace tokens and the final EOF token are not stored.
+    template <class TokenSpec>
+    class token_buffer
+    {
+    public:
+        /// \effects Creates an empty buffer that can store up to `capacity` tokens in the given
+        /// arrays.
+        /// \requires Each array must have room for at least `capacity` elements.
+        constexpr token_buffer(token_kind<TokenSpec>* kinds, std::size_t* offsets,
+                               std::size_t* lengths, std::size_t capacity) noexcept
+        : begin_(nullptr),
+          kinds_(kinds),
+          offsets_(offsets),
+          lengths_(lengths),
+          size_(0),
+          capacity_(capacity)
+        {}
+
+        //=== modifiers ===//
+        /// \effects Removes all tokens.
+        constexpr void clear() noexcept
+        {
+            begin_ = nullptr;
+            size_  = 0;
+        }
+
+        /// \effects Appends at most `n` tokens starting at the current token of the tokenizer,
+        /// but no more than fit into the buffer,
+        /// and advances the tokenizer past them.
+        /// \returns The number of tokens that were appended,
+        /// it is less than requested only if the buffer became full or the tokenizer is done.
+        /// \requires If the buffer is not empty,
+        /// the tokens must have been filled in from the same character range.
+        constexpr std::size_t fill(tokenizer<TokenSpec>& tokenizer, std::size_t n) noexcept
+        {
+            FOONATHAN_LEX_PRECONDITION(empty() || begin_ == tokenizer.begin_ptr(),
+                                       "tokens must come from the same character range");
+            begin_ = tokenizer.begin_ptr();
+
+            if (n > capacity_ - size_)
+                n = capacity_ - size_;
+
+            detail::bulk_tokenizer<TokenSpec> bulk{tokenizer.current_ptr(), tokenizer.end_ptr(),
+                                                   tokenizer.last_result_};
+            auto count = bulk.fill(begin_, kinds_ + size_, offsets_ + size_, lengths_ + size_, n);
+            size_ += count;
+
+            tokenizer.assign(bulk.ptr, bulk.result);
+            return count;
+        }
+
+        //=== access ===//
+        /// \returns The number of tokens stored.
+        constexpr std::size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        /// \returns The maximal number of tokens that can be stored.
+        constexpr std::size_t capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        /// \returns `size() == 0`.
+        constexpr bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        /// \returns `size() == capacity()`.
+        constexpr bool full() const noexcept
+        {
+            return size_ == capacity_;
+        }
+
+        /// \returns The beginning of the character range the tokens are from,
+        /// or `nullptr` if the buffer is empty.
+        constexpr const char* begin_ptr() const noexcept
+        {
+            return begin_;
+        }
+
+        /// \returns A pointer to the `size()` token kinds.
+        constexpr const token_kind<TokenSpec>* kinds() const noexcept
+        {
+            return kinds_;
+        }
+
+        /// \returns A pointer to the `size()` token offsets.
+        constexpr const std::size_t* offsets() const noexcept
+        {
+            return offsets_;
+        }
+
+        /// \returns A pointer to the `size()` token lengths.
+        constexpr const std::size_t* lengths() const noexcept
+        {
+            return lengths_;
+        }
+
+        /// \returns The `i`th token.
+        /// \requires `i < size()`.
+        constexpr token<TokenSpec> operator[](std::size_t i) const noexcept
+        {
+            FOONATHAN_LEX_PRECONDITION(i < size_, "index out of range");
+            return token<TokenSpec>(kinds_[i], begin_ + offsets_[i], lengths_[i]);
+        }
+
+    private:
+        const char*            begin_;
+        token_kind<TokenSpec>* kinds_;
+        std::size_t*           offsets_;
+        std::size_t*           lengths_;
+        std::size_t            size_;
+        std::size_t            capacity_;
+
+        template <class Spec>
+        friend constexpr const char* tokenize_all(const char* begin, const char* end,
+                                                  token_buffer<Spec>& buffer) noexcept;
+    };
+
+    /// Tokenizes the character range `[begin, end)` into the buffer.
+    /// \effects Clears the buffer and fills it with the tokens of the range,
+    /// until either all tokens are stored or the buffer is full.
+    /// This is equivalent to filling it from a [lex::tokenizer](), but without the overhead of
+    /// creating a token object for each token.
+    /// \returns A pointer to the beginning of the first token that was not stored,
+    /// or `end` if all tokens have been stored.
+    template <class TokenSpec>
+    constexpr const char* tokenize_all(const char* begin, const char* end,
+                                       token_buffer<TokenSpec>& buffer) noexcept
+    {
+        buffer.clear();
+        buffer.begin_ = begin;
+
+        detail::bulk_tokenizer<TokenSpec> bulk{begin, end, match_result<TokenSpec>::unmatched()};
+        bulk.reset(begin);
+        buffer.size_ = bulk.fill(begin, buffer.kinds_, buffer.offsets_, buffer.lengths_,
+                                 buffer.capacity_);
+        return bulk.ptr;
+    }
+} // namespace lex
+} // namespace foonathan
+
+#endif // FOONATHAN_LEX_TOKEN_BUFFER_HPP_INCLUDED
@@ -56,24 +56,21 @@ namespace lex
             return get_id_impl<TokenSpec, Token>::get();
         }
 
-        template <class TokenSpec, template <typename> class Category>
-        struct category_matcher
-        {
-            id_type<TokenSpec> id;
-            bool               result = false;
+        // whether or not the token with a given id is in the category
+        template <class TokenList, template <typename> class Category>
+        struct category_table;
 
-            template <typename T>
-            constexpr bool operator()(detail::type_list<T>)
-            {
-                if (id != get_id<TokenSpec, T>())
-                    return true;
-                else
-                {
-                    result = Category<T>::value;
-                    return false;
-                }
-            }
+        template <class... Tokens, template <typename> class Category>
+        struct category_table<detail::type_list<Tokens...>, Category>
+        {
+            // error and EOF are never part of a category
+            static constexpr bool value[sizeof...(Tokens) + 2] = {false, false,
+                                                                  Category<Tokens>::value...};
         };
+
+        template <class... Tokens, template <typename> class Category>
+        constexpr bool
+            category_table<detail::type_list<Tokens...>, Category>::value[sizeof...(Tokens) + 2];
     } // namespace token_kind_detail
 
     /// Information about the kind of a token.
@@ -127,12 +124,13 @@ namespace lex
             return id_ == token_kind_detail::get_id<TokenSpec, Token>();
         }
 
+        /// \returns Whether or not the token is in the specified category,
+        /// i.e. `Category<Token>::value` is `true`.
         template <template <typename> class Category>
         constexpr bool is_category() const noexcept
         {
-            token_kind_detail::category_matcher<TokenSpec, Category> matcher{id_, false};
-            detail::for_each(TokenSpec{}, matcher);
-            return matcher.result;
+            using table = token_kind_detail::category_table<typename TokenSpec::list, Category>;
+            return table::value[id_];
         }
 
         /// \returns The underlying integer value of the token.
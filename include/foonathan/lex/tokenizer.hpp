@@ -5,6 +5,10 @@
 #ifndef FOONATHAN_LEX_TOKENIZER_HPP_INCLUDED
 #define FOONATHAN_LEX_TOKENIZER_HPP_INCLUDED
 
+#include <foonathan/lex/detail/char_class.hpp>
+#include <foonathan/lex/detail/dfa.hpp>
+#include <foonathan/lex/detail/keyword_hash.hpp>
+#include <foonathan/lex/detail/tracked_end.hpp>
 #include <foonathan/lex/detail/trie.hpp>
 #include <foonathan/lex/identifier_token.hpp>
 #include <foonathan/lex/literal_token.hpp>
@@ -16,30 +20,55 @@ namespace foonathan
 {
 namespace lex
 {
+    /// Tag type to select the backend that matches the literal tokens by walking the trie.
+    ///
+    /// The trie is encoded in the type system and matching it generates fully inlined code.
+    /// This is the default.
+    struct trie_backend
+    {};
+
+    /// Tag type to select the backend that matches the literal tokens using a state transition
+    /// table.
+    ///
+    /// The trie is flattened into a table of a DFA at compile-time, which is then walked by a
+    /// loop. This generates a lot less code for big token specifications.
+    struct dfa_backend
+    {};
+
     namespace detail
     {
         //=== literal trie building ===//
         template <class TokenSpec, class LiteralTokens>
-        struct build_trie_impl;
+        struct literal_list;
 
-        template <class TokenSpec>
-        struct build_trie_impl<TokenSpec, type_list<>>
+        template <class TokenSpec, class... Literals>
+        struct literal_list<TokenSpec, type_list<Literals...>>
         {
-            using type = typename trie<TokenSpec>::empty;
+            using id_type = token_kind_detail::id_type<TokenSpec>;
+
+            static constexpr std::size_t count = sizeof...(Literals);
+
+            static constexpr const char* strings[count] = {literal_token_type<Literals>::value...};
+            static constexpr std::size_t lengths[count]
+                = {sizeof(literal_token_type<Literals>::value) - 1 ...};
+            static constexpr id_type ids[count]
+                = {token_kind_detail::get_id<TokenSpec, Literals>()...};
         };
 
-        template <class TokenSpec, typename Head, typename... Tail>
-        struct build_trie_impl<TokenSpec, type_list<Head, Tail...>>
+        template <class TokenSpec, class... Literals>
+        constexpr const char* literal_list<TokenSpec, type_list<Literals...>>::strings[];
+        template <class TokenSpec, class... Literals>
+        constexpr std::size_t literal_list<TokenSpec, type_list<Literals...>>::lengths[];
+        template <class TokenSpec, class... Literals>
+        constexpr typename literal_list<TokenSpec, type_list<Literals...>>::id_type
+            literal_list<TokenSpec, type_list<Literals...>>::ids[];
+
+        template <class TokenSpec>
+        struct literal_list<TokenSpec, type_list<>>
         {
-            using base = typename build_trie_impl<TokenSpec, type_list<Tail...>>::type;
-            using type = typename trie<TokenSpec>::template insert_literal_str<
-                base, token_kind<TokenSpec>(Head{}).get(), literal_token_type<Head>>;
+            static constexpr std::size_t count = 0;
         };
 
-        template <class TokenSpec, class LiteralTokens>
-        using literal_trie =
-            typename build_trie_impl<TokenSpec, typename LiteralTokens::list>::type;
-
         //=== keyword and identifier trie ===//
         template <class TokenSpec, class Identifiers, class Keywords>
         struct keyword_identifier_matcher
@@ -55,24 +84,24 @@ namespace lex
                 return Identifier::is_conflicting_literal(kind);
             }
 
-            static constexpr match_result<TokenSpec> try_match(const char* str,
-                                                               const char* end) noexcept
+            template <class End>
+            static constexpr match_result<TokenSpec> try_match(const char* str, End end) noexcept
             {
-                auto identifier = Identifier::try_match(str, end);
+                auto identifier = try_match_rule<Identifier>(str, end);
                 if (!identifier.is_success())
                     // not an identifier, so can't be a keyword
                     return identifier;
 
-                // try to match a keyword in the identifier
-                auto identifier_begin = str;
-                auto identifier_end   = str + identifier.bump;
-                auto keyword = literal_trie<TokenSpec, Keywords>::try_match(identifier_begin,
-                                                                            identifier_end);
-                if (keyword.is_matched() && keyword.bump == identifier.bump)
-                    // we've matched a keyword and it isn't a prefix but the whole string
+                // check whether the identifier is a keyword,
+                // most identifiers are rejected by their length and first character alone
+                using keywords = keyword_hash_table<TokenSpec, typename Keywords::list>;
+                if (!keywords::is_candidate(str, identifier.bump))
+                    return identifier;
+
+                auto keyword = keywords::try_match(str, identifier.bump);
+                if (keyword.is_matched())
                     return keyword;
                 else
-                    // didn't match keyword or it was only a prefix
                     return identifier;
             }
         };
@@ -87,7 +116,8 @@ namespace lex
                 return false;
             }
 
-            static constexpr match_result<TokenSpec> try_match(const char*, const char*) noexcept
+            template <class End>
+            static constexpr match_result<TokenSpec> try_match(const char*, End) noexcept
             {
                 // no identifier rule, so will never match
                 return match_result<TokenSpec>::unmatched();
@@ -95,19 +125,6 @@ namespace lex
         };
 
         //=== try_match ===//
-        template <class TokenSpec, class Root, class Rules>
-        struct insert_rules
-        {
-            using type = Root;
-        };
-
-        template <class TokenSpec, class Root, class Head, class... Tail>
-        struct insert_rules<TokenSpec, Root, type_list<Head, Tail...>>
-        {
-            using with_head = typename trie<TokenSpec>::template insert_rule<Root, Head>;
-            using type      = typename insert_rules<TokenSpec, with_head, type_list<Tail...>>::type;
-        };
-
         template <class TokenSpec>
         struct build_trie
         {
@@ -117,20 +134,528 @@ namespace lex
             using rule_tokens = keep_if<TokenSpec, is_non_identifier_rule_token>;
             using literals    = keep_if<TokenSpec, is_non_keyword_literal_token>;
 
-            // start with the literal trie
-            using trie0 = detail::literal_trie<TokenSpec, literals>;
-            // insert all rule tokens
-            using trie1 = typename insert_rules<TokenSpec, trie0, rule_tokens>::type;
-            // insert the keyword identifier rule
+            // the rule tokens are followed by the keyword identifier rule
             using keyword_identifier_matcher
                 = detail::keyword_identifier_matcher<TokenSpec, identifiers, keywords>;
-            using trie2 =
-                typename detail::trie<TokenSpec>::template insert_rule<trie1,
-                                                                       keyword_identifier_matcher>;
+            using rules = concat<rule_tokens, keyword_identifier_matcher>;
+
+            // the trie is built from the sorted literals in one pass,
+            // instead of inserting the literals and rules one by one
+            using type = typename detail::trie<TokenSpec>::template build<
+                literal_list<TokenSpec, literals>, rules>;
+        };
+
+        template <class TokenSpec>
+        using token_spec_trie = typename build_trie<TokenSpec>::type;
+
+        //=== backend selection ===//
+        template <class TokenSpec, typename = void>
+        struct token_spec_backend
+        {
+            using type = trie_backend;
+        };
+
+        template <class TokenSpec>
+        struct token_spec_backend<TokenSpec, decltype(void(typename TokenSpec::backend{}))>
+        {
+            using type = typename TokenSpec::backend;
+        };
+
+        template <class TokenSpec, class Backend>
+        struct token_spec_matcher_impl;
+
+        template <class TokenSpec>
+        struct token_spec_matcher_impl<TokenSpec, trie_backend>
+        {
+            using type = token_spec_trie<TokenSpec>;
+        };
+
+        template <class TokenSpec>
+        struct token_spec_matcher_impl<TokenSpec, dfa_backend>
+        {
+            using type = dfa<TokenSpec, token_spec_trie<TokenSpec>>;
+        };
+
+        //=== error coalescing ===//
+        template <class TokenSpec, typename = void>
+        struct token_spec_coalesce_errors : std::false_type
+        {};
+
+        template <class TokenSpec>
+        struct token_spec_coalesce_errors<TokenSpec, decltype(void(TokenSpec::coalesce_errors))>
+        : std::integral_constant<bool, TokenSpec::coalesce_errors>
+        {};
+
+        // the characters a token can start with
+        //
+        // Rule tokens whose rule can't be evaluated at compile-time can start with anything.
+        template <class TokenSpec, class Token, typename = void>
+        struct token_first_set
+        {
+            static constexpr token_rule::detail::first_set get() noexcept
+            {
+                return token_rule::detail::make_first_set(is_rule_token<Token>::value, false);
+            }
+        };
+
+        template <class TokenSpec, class Token>
+        struct token_first_set<TokenSpec, Token, std::enable_if_t<is_literal_token<Token>::value>>
+        {
+            static constexpr token_rule::detail::first_set get() noexcept
+            {
+                return token_rule::detail::make_first_set(make_char_class(
+                                                              literal_token_type<Token>::value[0]),
+                                                          false);
+            }
+        };
+
+        template <class TokenSpec, class Token>
+        struct token_first_set<
+            TokenSpec, Token,
+            std::enable_if_t<std::is_base_of<rule_token<Token, TokenSpec>, Token>::value
+                             && token_rule::detail::is_compile_time_rule<Token>::value>>
+        {
+            static constexpr token_rule::detail::first_set get() noexcept
+            {
+                return token_rule::detail::get_first_set(
+                    token_rule::detail::compiled_token_rule<Token>{});
+            }
+        };
+
+        // the characters no token can start with
+        template <class TokenSpec, class Tokens = typename TokenSpec::list>
+        struct token_spec_error_chars;
+
+        template <class TokenSpec, class... Tokens>
+        struct token_spec_error_chars<TokenSpec, type_list<Tokens...>>
+        {
+            static constexpr char_class build() noexcept
+            {
+                token_rule::detail::first_set sets[]
+                    = {token_first_set<TokenSpec, Tokens>::get()...,
+                       token_rule::detail::make_first_set(false, false)};
+
+                char_class result{};
+                for (auto i = 0u; i != 256u; ++i)
+                {
+                    auto can_start = false;
+                    for (auto& set : sets)
+                        can_start = can_start || set.contains[i];
+
+                    if (!can_start)
+                        insert_char(result, static_cast<char>(static_cast<unsigned char>(i)));
+                }
+                return finish_char_class(result);
+            }
+
+            static constexpr char_class value = build();
+        };
+
+        template <class TokenSpec, class... Tokens>
+        constexpr char_class token_spec_error_chars<TokenSpec, type_list<Tokens...>>::value;
+
+        // matches a single error token for a run of characters where no token matches
+        template <class TokenSpec, class Matcher>
+        struct error_coalescing_matcher
+        {
+            using error_chars = token_spec_error_chars<TokenSpec>;
+
+            static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                               const char* end) noexcept
+            {
+                return match(str, end);
+            }
+
+            static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                               const tracked_end& end) noexcept
+            {
+                return match(str, end);
+            }
+
+            static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                               std::size_t size) noexcept
+            {
+                return try_match(str, str + size);
+            }
+
+        private:
+            template <class End>
+            static constexpr match_result<TokenSpec> match(const char* str, End end) noexcept
+            {
+                auto result = Matcher::try_match(str, end);
+                if (!result.is_error())
+                    return result;
+
+                auto cur = str + result.bump;
+                while (true)
+                {
+                    // no need to try a match on characters that can't start a token
+                    cur = skip_char_class(error_chars::value, cur, get_end(end));
+                    if (cur == end)
+                        break;
+
+                    auto next = Matcher::try_match(cur, end);
+                    if (!next.is_error())
+                        break;
+                    cur += next.bump;
+                }
+
+                return match_result<TokenSpec>::error(static_cast<std::size_t>(cur - str));
+            }
+        };
+
+        template <class TokenSpec, class Matcher,
+                  bool Coalesce = token_spec_coalesce_errors<TokenSpec>::value>
+        struct token_spec_error_matcher
+        {
+            using type = Matcher;
+        };
+
+        template <class TokenSpec, class Matcher>
+        struct token_spec_error_matcher<TokenSpec, Matcher, true>
+        {
+            using type = error_coalescing_matcher<TokenSpec, Matcher>;
+        };
+
+        template <class TokenSpec>
+        using token_spec_inline_matcher = typename token_spec_error_matcher<
+            TokenSpec, typename token_spec_matcher_impl<
+                           TokenSpec, typename token_spec_backend<TokenSpec>::type>::type>::type;
+
+        //=== extern matcher ===//
+        // argument of the functions declared by FOONATHAN_LEX_DECLARE_TOKENIZER() and
+        // FOONATHAN_LEX_DECLARE_PARSER(), they are found by ADL
+        template <class... T>
+        struct extern_tag
+        {};
+
+        template <class TokenSpec, typename = void>
+        struct token_spec_extern_tokenizer : std::false_type
+        {};
+
+        template <class TokenSpec>
+        struct token_spec_extern_tokenizer<TokenSpec,
+                                           decltype(void(TokenSpec::extern_tokenizer))>
+        : std::integral_constant<bool, TokenSpec::extern_tokenizer>
+        {};
+
+        template <class TokenSpec, typename = void>
+        struct has_extern_matcher : std::false_type
+        {};
+        template <class TokenSpec>
+        struct has_extern_matcher<TokenSpec, decltype(void(foonathan_lex_extern_match(
+                                                 extern_tag<TokenSpec>{}, nullptr, nullptr)))>
+        : std::true_type
+        {};
+
+        template <class TokenSpec, bool Extern = token_spec_extern_tokenizer<TokenSpec>::value>
+        struct token_spec_matcher_impl_extern
+        {
+            using type = token_spec_inline_matcher<TokenSpec>;
+        };
+
+        // calls the matcher defined by FOONATHAN_LEX_DEFINE_TOKENIZER(),
+        // so the inline matcher isn't instantiated
+        template <class TokenSpec>
+        struct token_spec_matcher_impl_extern<TokenSpec, true>
+        {
+            static_assert(has_extern_matcher<TokenSpec>::value,
+                          "token specification with extern_tokenizer requires "
+                          "FOONATHAN_LEX_DECLARE_TOKENIZER()");
+
+            struct type
+            {
+                static constexpr match_result<TokenSpec> try_match(const char* str,
+                                                                   const char* end) noexcept
+                {
+                    return foonathan_lex_extern_match(extern_tag<TokenSpec>{}, str, end);
+                }
+            };
+        };
+
+        template <class TokenSpec>
+        using token_spec_matcher = typename token_spec_matcher_impl_extern<TokenSpec>::type;
+
+        //=== whitespace skipping ===//
+        // rules that are just a repetition of an ascii predicate
+        template <class Rule>
+        struct char_class_repetition : std::false_type
+        {};
+
+        template <typename Predicate>
+        struct char_class_repetition<
+            token_rule::detail::zero_or_more<token_rule::detail::ascii_predicate<Predicate>>>
+        : std::true_type
+        {
+            template <class Rule>
+            static constexpr Predicate predicate(Rule rule) noexcept
+            {
+                return rule.r.p;
+            }
+        };
+
+        template <typename Predicate>
+        struct char_class_repetition<token_rule::detail::sequence<
+            token_rule::detail::ascii_predicate<Predicate>,
+            token_rule::detail::zero_or_more<token_rule::detail::ascii_predicate<Predicate>>>>
+        : std::true_type
+        {
+            template <class Rule>
+            static constexpr Predicate predicate(Rule rule) noexcept
+            {
+                return rule.r2.r.p;
+            }
+        };
+
+        // the character class of a whitespace token that is a character class repetition
+        template <class Token, typename = void>
+        struct whitespace_char_class
+        {
+            static constexpr bool is_valid = false;
+        };
+
+        template <class Token>
+        struct whitespace_char_class<
+            Token, std::enable_if_t<is_whitespace<Token>::value
+                                    && char_class_repetition<decltype(Token::rule())>::value>>
+        {
+            using repetition = char_class_repetition<decltype(Token::rule())>;
+
+            static constexpr bool       is_valid = true;
+            static constexpr char_class value
+                = make_char_class(repetition::predicate(Token::rule()));
+        };
+
+        template <class Token>
+        constexpr char_class whitespace_char_class<
+            Token, std::enable_if_t<is_whitespace<Token>::value
+                                    && char_class_repetition<decltype(Token::rule())>::value>>::
+            value;
+
+        template <class Class, class... Literals>
+        constexpr bool no_literal_starts_with(type_list<Literals...>) noexcept
+        {
+            bool result  = true;
+            bool dummy[] = {(result = result
+                                      && !Class::value.contains[static_cast<unsigned char>(
+                                          Literals::value[0])],
+                             true)...,
+                            true};
+            (void)dummy;
+            return result;
+        }
+
+        template <class List>
+        struct first_impl
+        {
+            using type = void;
+        };
+
+        template <class Head, class... Tail>
+        struct first_impl<type_list<Head, Tail...>>
+        {
+            using type = Head;
+        };
+
+        // skips whitespace without going through the trie
+        //
+        // This is possible if the first rule token is a whitespace token consisting of a character
+        // class repetition: the rules are tried in order, so if no literal token starts with a
+        // character of the class, the whitespace token is the one that will match.
+        template <class TokenSpec>
+        struct whitespace_skipper
+        {
+            using first_rule = typename first_impl<
+                typename keep_if<TokenSpec, is_non_identifier_rule_token>::list>::type;
+            using char_class = whitespace_char_class<first_rule>;
+
+            static constexpr bool can_skip(std::false_type /* is_valid */) noexcept
+            {
+                return false;
+            }
+            static constexpr bool can_skip(std::true_type /* is_valid */) noexcept
+            {
+                return no_literal_starts_with<char_class>(
+                    keep_if<TokenSpec, is_non_keyword_literal_token>{});
+            }
+
+            static constexpr const char* skip(std::false_type, const char* cur,
+                                              const char*) noexcept
+            {
+                return cur;
+            }
+            static constexpr const char* skip(std::true_type, const char* cur,
+                                              const char* end) noexcept
+            {
+                return skip_char_class(char_class::value, cur, end);
+            }
+
+            static constexpr const char* skip(const char* cur, const char* end) noexcept
+            {
+                using is_valid = std::integral_constant<bool, char_class::is_valid>;
+                using enabled  = std::integral_constant<bool, can_skip(is_valid{})>;
+                return skip(enabled{}, cur, end);
+            }
+        };
+
+        //=== next token ===//
+        // matches the next token that isn't whitespace
+        //
+        // `End` is the type of the end passed to the matcher,
+        // e.g. a tracked_end to know how far the matches have looked.
+        template <class TokenSpec, class Matcher = token_spec_matcher<TokenSpec>>
+        struct next_token
+        {
+            using whitespace     = whitespace_skipper<TokenSpec>;
+            using any_whitespace = any_of<TokenSpec, is_whitespace>;
+
+            static constexpr bool is_whitespace_token(std::true_type,
+                                                      match_result<TokenSpec> result) noexcept
+            {
+                return result.kind.template is_category<is_whitespace>();
+            }
+            static constexpr bool is_whitespace_token(std::false_type,
+                                                      match_result<TokenSpec>) noexcept
+            {
+                return false;
+            }
+
+            // skips whitespace characters and matches the token starting after them,
+            // returns whether it is a whitespace token that has to be skipped as well
+            template <class End>
+            static constexpr bool match_one(const char*& ptr, match_result<TokenSpec>& result,
+                                            End end) noexcept
+            {
+                ptr    = whitespace::skip(ptr, get_end(end));
+                result = Matcher::try_match(ptr, end);
+                return is_whitespace_token(any_whitespace{}, result);
+            }
+
+            // sets `ptr` to the beginning of the first non-whitespace token at or after it,
+            // and `result` to its match
+            template <class End>
+            static constexpr void match(const char*& ptr, match_result<TokenSpec>& result,
+                                        End end) noexcept
+            {
+                while (match_one(ptr, result, end))
+                    ptr += result.bump;
+            }
+        };
+
+        //=== lookahead cache ===//
+        template <class TokenSpec, typename = void>
+        struct token_spec_lookahead : std::integral_constant<std::size_t, 0>
+        {};
+
+        template <class TokenSpec>
+        struct token_spec_lookahead<TokenSpec, decltype(void(TokenSpec::lookahead))>
+        : std::integral_constant<std::size_t, TokenSpec::lookahead>
+        {};
+
+        // the tokens that have been matched most recently, in order
+        //
+        // Tokens are numbered by the order in which they were matched,
+        // the ones in [begin_, end_) are stored, and cursor_ is the current one.
+        template <class TokenSpec, std::size_t Capacity>
+        class token_cache
+        {
+        public:
+            struct entry
+            {
+                const char*             ptr    = nullptr;
+                match_result<TokenSpec> result = match_result<TokenSpec>::unmatched();
+            };
+
+            constexpr token_cache() noexcept : entries_{}, begin_(0), end_(0), cursor_(0) {}
+
+            // the number of tokens that are stored after the current one
+            constexpr std::size_t ahead() const noexcept
+            {
+                return end_ - cursor_ - 1;
+            }
+
+            // the token n tokens after the current one, n <= ahead()
+            constexpr const entry& get(std::size_t n) const noexcept
+            {
+                return entries_[(cursor_ + n) % Capacity];
+            }
+
+            // the last token that was matched
+            constexpr const entry& newest() const noexcept
+            {
+                return entries_[(end_ - 1) % Capacity];
+            }
+
+            // forgets all tokens, except for the given current one
+            constexpr void restart(const char* ptr, match_result<TokenSpec> result) noexcept
+            {
+                begin_   = 0;
+                end_     = 0;
+                cursor_  = 0;
+                append(ptr, result);
+            }
+
+            // stores the token matched after newest(),
+            // it may evict the oldest token but not the current one
+            constexpr void append(const char* ptr, match_result<TokenSpec> result) noexcept
+            {
+                if (end_ - begin_ == Capacity)
+                    ++begin_;
+
+                auto& e  = entries_[end_ % Capacity];
+                e.ptr    = ptr;
+                e.result = result;
+                ++end_;
+            }
+
+            // makes the token after the current one current, if it is stored
+            constexpr bool next(const char*& ptr, match_result<TokenSpec>& result) noexcept
+            {
+                if (ahead() == 0)
+                    return false;
+
+                ++cursor_;
+                ptr    = get(0).ptr;
+                result = get(0).result;
+                return true;
+            }
+
+            // makes the token starting at ptr current, if it is stored
+            constexpr bool seek(const char* ptr, match_result<TokenSpec>& result) noexcept
+            {
+                for (auto i = begin_; i != end_; ++i)
+                    if (entries_[i % Capacity].ptr == ptr)
+                    {
+                        cursor_ = i;
+                        result  = get(0).result;
+                        return true;
+                    }
+                return false;
+            }
+
+        private:
+            entry       entries_[Capacity];
+            std::size_t begin_, end_, cursor_;
         };
 
         template <class TokenSpec>
-        using token_spec_trie = typename build_trie<TokenSpec>::trie2;
+        class token_cache<TokenSpec, 0>
+        {
+        public:
+            constexpr void restart(const char*, match_result<TokenSpec>) noexcept {}
+
+            constexpr void append(const char*, match_result<TokenSpec>) noexcept {}
+
+            constexpr bool next(const char*&, match_result<TokenSpec>&) noexcept
+            {
+                return false;
+            }
+
+            constexpr bool seek(const char*, match_result<TokenSpec>&) noexcept
+            {
+                return false;
+            }
+        };
     } // namespace detail
 
     /// Tokenizes a character range according the token specification.
@@ -139,18 +664,54 @@ namespace lex
     /// The token that matches will be stored and the position advanced.
     /// If no token matched, it will store an error token and advance to the next character.
     /// If a token rule matched an error token, it will be transparently forwarded.
+    /// If the token specification is a class inheriting from [lex::token_spec]() with a member
+    /// `static constexpr bool coalesce_errors = true;`, it will instead store a single error token
+    /// for the entire run of characters where no token matches:
+    /// it skips all characters no token can start with, which is computed at compile-time from
+    /// the literals and rules, and stops at the first one where a token matches.
     ///
-    /// It will only store one token in memory.
+    /// By default, it will only store one token in memory.
     /// Parsers requiring look ahead can be implemented by resetting the tokenizer to an earlier
-    /// position, if necessary.
+    /// position, if necessary, or by using `peek(n)`.
+    /// If the token specification is a class inheriting from [lex::token_spec]() with a member
+    /// `static constexpr std::size_t lookahead = N;`, the tokenizer caches the last `N` tokens it
+    /// has matched instead: `peek(n)` then matches each token only once,
+    /// and `reset()` to the start of a cached token replays the cached results.
+    ///
+    /// The literal tokens are matched using [lex::trie_backend]() by default.
+    /// If the token specification is a class inheriting from [lex::token_spec]() with a member
+    /// `using backend = lex::dfa_backend;`, the [lex::dfa_backend]() is used instead.
+    ///
+    /// If the token specification has a member `static constexpr bool extern_tokenizer = true;`,
+    /// the tokens are matched by the function declared by [FOONATHAN_LEX_DECLARE_TOKENIZER]().
     template <class TokenSpec>
     class tokenizer
     {
-        using trie = detail::token_spec_trie<TokenSpec>;
+        using trie       = detail::token_spec_matcher<TokenSpec>;
+        using next_token = detail::next_token<TokenSpec>;
+        using lookahead  = detail::token_spec_lookahead<TokenSpec>;
         static_assert(detail::all_of<TokenSpec, is_token>::value,
                       "invalid types in token specifications");
 
     public:
+        /// A position in the token stream, created by `mark()`.
+        class marker
+        {
+        public:
+            /// \returns The position of the token that was current when it was created.
+            constexpr const char* position() const noexcept
+            {
+                return ptr_;
+            }
+
+        private:
+            explicit constexpr marker(const char* ptr) noexcept : ptr_(ptr) {}
+
+            const char* ptr_;
+
+            friend tokenizer;
+        };
+
         //=== constructors ===//
         /// \effects Creates a tokenizer that will tokenize the range `[ptr, ptr + size)`.
         explicit constexpr tokenizer(const char* ptr, std::size_t size) noexcept
@@ -161,7 +722,8 @@ namespace lex
         explicit constexpr tokenizer(const char* begin, const char* end)
         : begin_(begin), ptr_(begin), end_(end), last_result_(match_result<TokenSpec>::unmatched())
         {
-            bump();
+            advance(ptr_, last_result_, end_);
+            cache_.restart(ptr_, last_result_);
         }
 
         /// \effects Creates a tokenizer that will tokenize the given array *excluding* a null
@@ -177,6 +739,15 @@ namespace lex
             return token<TokenSpec>(last_result_.kind, ptr_, last_result_.bump);
         }
 
+        /// \returns The token `n` tokens after the current one, or EOF if there are not that many.
+        /// `peek(0)` is equivalent to `peek()`.
+        /// \effects Matches the tokens, unless they are cached already.
+        /// \requires If the token specification has a `lookahead` member, `n < lookahead`.
+        constexpr token<TokenSpec> peek(std::size_t n) noexcept
+        {
+            return peek(std::integral_constant<bool, lookahead::value != 0>{}, n);
+        }
+
         /// \returns Whether or not EOF was reached.
         /// If this is `true`, `bump()` will have no effect anymore and `peek()` returns EOF.
         constexpr bool is_done() const noexcept
@@ -200,19 +771,46 @@ namespace lex
         /// EOF.
         constexpr void bump() noexcept
         {
-            using any_whitespace = detail::any_of<TokenSpec, is_whitespace>;
-            reset(ptr_ + last_result_.bump);
-            skip_whitespace(any_whitespace{});
+            if (cache_.next(ptr_, last_result_))
+                return;
+
+            auto was_eof = last_result_.is_eof();
+            advance(ptr_, last_result_, end_);
+            if (!was_eof)
+            {
+                cache_.append(ptr_, last_result_);
+                cache_.next(ptr_, last_result_);
+            }
         }
 
         /// \effects Resets the tokenizer to the specified position and parses that token
         /// immediately.
+        /// If the token at that position is cached, its result is used instead.
         constexpr void reset(const char* position) noexcept
         {
             FOONATHAN_LEX_PRECONDITION(begin_ <= position && position <= end_,
                                        "position out of range");
-            ptr_         = position;
-            last_result_ = trie::try_match(ptr_, end_);
+            ptr_ = position;
+            if (!cache_.seek(ptr_, last_result_))
+            {
+                last_result_ = trie::try_match(ptr_, end_);
+                cache_.restart(ptr_, last_result_);
+            }
+        }
+
+        /// \returns A marker for the current token.
+        constexpr marker mark() const noexcept
+        {
+            return marker(ptr_);
+        }
+
+        /// \effects Makes the token that was current when the marker was created current again,
+        /// same as `reset(m.position())`.
+        /// \requires The marker must have been created by a tokenizer for the same character
+        /// range.
+        constexpr void rewind(marker m) noexcept
+        {
+            reset(m.ptr_);
         }
 
         //=== getters ===//
@@ -237,19 +835,81 @@ namespace lex
         }
 
     private:
-        constexpr void skip_whitespace(std::true_type)
+        constexpr token<TokenSpec> peek(std::false_type /* cached */, std::size_t n) const noexcept
         {
-            while (last_result_.kind.template is_category<is_whitespace>())
-                reset(ptr_ + last_result_.bump);
+            auto copy = *this;
+            for (auto i = std::size_t(0); i != n; ++i)
+                copy.bump();
+            return copy.peek();
+        }
+        constexpr token<TokenSpec> peek(std::true_type /* cached */, std::size_t n) noexcept
+        {
+            FOONATHAN_LEX_PRECONDITION(n < lookahead::value, "not enough lookahead");
+            while (cache_.ahead() < n && !cache_.newest().result.is_eof())
+            {
+                auto ptr    = cache_.newest().ptr;
+                auto result = cache_.newest().result;
+                advance(ptr, result, end_);
+                cache_.append(ptr, result);
+            }
+
+            auto& entry = n <= cache_.ahead() ? cache_.get(n) : cache_.newest();
+            return token<TokenSpec>(entry.result.kind, entry.ptr, entry.result.bump);
+        }
+
+        // matches the next token after the given one
+        static constexpr void advance(const char*& ptr, match_result<TokenSpec>& result,
+                                      const char* end) noexcept
+        {
+            ptr += result.bump;
+            next_token::match(ptr, result, end);
+        }
+
+        // sets the current token, after it was matched by someone else
+        constexpr void assign(const char* ptr, match_result<TokenSpec> result) noexcept
+        {
+            ptr_         = ptr;
+            last_result_ = result;
+            cache_.restart(ptr_, last_result_);
         }
-        constexpr void skip_whitespace(std::false_type) {}
 
         const char* begin_{};
         const char* ptr_{};
         const char* end_{};
 
         match_result<TokenSpec> last_result_;
+
+        detail::token_cache<TokenSpec, lookahead::value> cache_;
+
+        friend token_buffer<TokenSpec>;
     };
+
+    /// Declares the function that matches the tokens of `TokenSpec`,
+    /// defined in a single translation unit using [FOONATHAN_LEX_DEFINE_TOKENIZER]().
+    ///
+    /// `TokenSpec` must be a class inheriting from [lex::token_spec]() with a member
+    /// `static constexpr bool extern_tokenizer = true;`,
+    /// and the macro must be used in its namespace, e.g. right after its definition.
+    /// [lex::tokenizer]() and [lex::token_buffer]() then call that function instead of matching the
+    /// tokens inline, so other translation units don't have to instantiate and compile the matching
+    /// code; using them without the declaration is an error.
+    /// [lex::streaming_tokenizer]() still matches inline, as it needs to know how far a match has
+    /// looked at the input.
+    /// As the function is not `constexpr`, they can no longer be used in constant expressions with
+    /// that token specification.
+#define FOONATHAN_LEX_DECLARE_TOKENIZER(TokenSpec)                                                 \
+    foonathan::lex::match_result<TokenSpec> foonathan_lex_extern_match(                            \
+        foonathan::lex::detail::extern_tag<TokenSpec>, const char* str, const char* end) noexcept
+
+    /// Defines the function declared by [FOONATHAN_LEX_DECLARE_TOKENIZER]().
+    ///
+    /// It must be used in the same namespace in exactly one translation unit.
+#define FOONATHAN_LEX_DEFINE_TOKENIZER(TokenSpec)                                                  \
+    FOONATHAN_LEX_DECLARE_TOKENIZER(TokenSpec)                                                     \
+    {                                                                                              \
+        return foonathan::lex::detail::token_spec_inline_matcher<TokenSpec>::try_match(str, end);  \
+    }                                                                                              \
+    static_assert(true, "")
 } // namespace lex
 } // namespace foonathan
 
@@ -0,0 +1,77 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/compact_token.hpp>
+
+#include "tokenize.hpp"
+#include <catch.hpp>
+
+namespace
+{
+using test_spec = lex::token_spec<struct token_a, struct token_bc, struct token_d>;
+
+struct token_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct token_bc : FOONATHAN_LEX_LITERAL("bc")
+{};
+
+// token_d: any number of 'd'
+struct token_d : lex::basic_rule_token<token_d, test_spec>
+{
+    static constexpr const char* name = "<d>";
+
+    static constexpr match_result try_match(const char* str, const char* end) noexcept
+    {
+        auto cur = str;
+        while (cur != end && *cur == 'd')
+            ++cur;
+        return cur == str ? unmatched() : success(std::size_t(cur - str));
+    }
+};
+
+template <class Token>
+void verify(const lex::tokenizer<test_spec>&       tokenizer,
+            const lex::compact_token<test_spec>& token, std::size_t offset, const char* spelling)
+{
+    REQUIRE(token.is(Token{}));
+    REQUIRE(token.kind() == Token{});
+    REQUIRE(token.offset() == offset);
+    REQUIRE(token.spelling(tokenizer) == spelling);
+    REQUIRE(token.spelling(tokenizer).data() == tokenizer.begin_ptr() + offset);
+}
+
+constexpr std::size_t compact_length(const char* str, std::size_t size)
+{
+    auto tokenizer = lex::tokenizer<test_spec>(str, size);
+    return lex::compact_token<test_spec>(tokenizer, tokenizer.peek()).length();
+}
+} // namespace
+
+TEST_CASE("compact_token")
+{
+    REQUIRE(sizeof(lex::compact_token<test_spec>) == 8u);
+    REQUIRE(lex::compact_token<test_spec>::max_length == 0xFFFFFFu);
+
+    static constexpr const char array[] = "abcdddxbca";
+    lex::tokenizer<test_spec>   tokenizer(array);
+
+    lex::compact_token<test_spec> tokens[6];
+    for (auto& token : tokens)
+        token = lex::compact_token<test_spec>(tokenizer, tokenizer.get());
+    REQUIRE(tokenizer.is_done());
+
+    verify<token_a>(tokenizer, tokens[0], 0, "a");
+    verify<token_bc>(tokenizer, tokens[1], 1, "bc");
+    verify<token_d>(tokenizer, tokens[2], 3, "ddd");
+    verify<lex::error_token>(tokenizer, tokens[3], 6, "x");
+    verify<token_bc>(tokenizer, tokens[4], 7, "bc");
+    verify<token_a>(tokenizer, tokens[5], 9, "a");
+
+    REQUIRE(!tokens[3]);
+    REQUIRE(tokens[1].name() == std::string("bc"));
+
+    constexpr auto length = compact_length("dddd", 4);
+    REQUIRE(length == 4);
+}
@@ -0,0 +1,200 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/detail/char_class.hpp>
+
+#include <catch.hpp>
+#include <cstring>
+#include <string>
+
+using namespace foonathan::lex;
+
+namespace
+{
+struct is_blank
+{
+    constexpr bool operator()(char c) const noexcept
+    {
+        return c == ' ' || c == '\t';
+    }
+};
+
+struct is_digit
+{
+    constexpr bool operator()(char c) const noexcept
+    {
+        return c >= '0' && c <= '9';
+    }
+};
+
+struct is_not_x
+{
+    constexpr bool operator()(char c) const noexcept
+    {
+        return c != 'x';
+    }
+};
+
+struct is_alnum
+{
+    constexpr bool operator()(char c) const noexcept
+    {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+               || c == '_';
+    }
+};
+
+struct is_multiple_of_17
+{
+    constexpr bool operator()(char c) const noexcept
+    {
+        return static_cast<unsigned char>(c) % 17 == 0;
+    }
+};
+
+struct blank
+{
+    static constexpr detail::char_class value = detail::make_char_class(is_blank{});
+};
+constexpr detail::char_class blank::value;
+
+struct digit
+{
+    static constexpr detail::char_class value = detail::make_char_class(is_digit{});
+};
+constexpr detail::char_class digit::value;
+
+struct not_x
+{
+    static constexpr detail::char_class value = detail::make_char_class(is_not_x{});
+};
+constexpr detail::char_class not_x::value;
+
+struct blank_or_x
+{
+    static constexpr detail::char_class value
+        = detail::char_class_union(blank::value, detail::make_char_class('x'));
+};
+constexpr detail::char_class blank_or_x::value;
+
+struct not_blank
+{
+    static constexpr detail::char_class value = detail::char_class_complement(blank::value);
+};
+constexpr detail::char_class not_blank::value;
+
+struct alnum
+{
+    static constexpr detail::char_class value = detail::make_char_class(is_alnum{});
+};
+constexpr detail::char_class alnum::value;
+
+struct multiple_of_17
+{
+    static constexpr detail::char_class value = detail::make_char_class(is_multiple_of_17{});
+};
+constexpr detail::char_class multiple_of_17::value;
+
+template <class Class>
+bool verify_nibbles()
+{
+    for (auto i = 0u; i != 256u; ++i)
+    {
+        auto& cls      = Class::value;
+        auto  in_class = (cls.low_nibbles[i & 0xF] & cls.high_nibbles[i >> 4]) != 0;
+        if (in_class != cls.contains[i])
+            return false;
+    }
+    return true;
+}
+
+template <class Class>
+std::size_t skip(const std::string& str)
+{
+    auto begin = str.data();
+    return std::size_t(detail::skip_char_class(Class::value, begin, begin + str.size()) - begin);
+}
+
+constexpr std::size_t skip_constexpr(const char* str)
+{
+    auto end = str;
+    while (*end)
+        ++end;
+    return std::size_t(detail::skip_char_class(blank::value, str, end) - str);
+}
+} // namespace
+
+TEST_CASE("detail::char_class")
+{
+    REQUIRE(blank::value.char_count == 2);
+    REQUIRE(blank::value.is_vectorizable());
+    REQUIRE(blank::value.contains[static_cast<unsigned char>(' ')]);
+    REQUIRE(!blank::value.contains[static_cast<unsigned char>('a')]);
+
+    REQUIRE(digit::value.char_count == 10);
+    REQUIRE(!digit::value.is_vectorizable());
+
+    REQUIRE(not_x::value.char_count == 255);
+    REQUIRE(!not_x::value.contains[static_cast<unsigned char>('x')]);
+    REQUIRE(not_x::value.contains[0xFF]);
+    REQUIRE(not_x::value.chars_excluded);
+    REQUIRE(not_x::value.is_vectorizable());
+
+    REQUIRE(not_blank::value.char_count == 254);
+    REQUIRE(!not_blank::value.contains[static_cast<unsigned char>('\t')]);
+    REQUIRE(not_blank::value.contains[static_cast<unsigned char>('a')]);
+    REQUIRE(not_blank::value.vector_char_count() == 2);
+
+    REQUIRE(blank_or_x::value.char_count == 3);
+    REQUIRE(blank_or_x::value.contains[static_cast<unsigned char>('\t')]);
+    REQUIRE(blank_or_x::value.contains[static_cast<unsigned char>('x')]);
+    REQUIRE(!blank_or_x::value.contains[static_cast<unsigned char>('a')]);
+
+    REQUIRE(blank::value.has_nibbles);
+    REQUIRE(verify_nibbles<blank>());
+    REQUIRE(digit::value.has_nibbles);
+    REQUIRE(verify_nibbles<digit>());
+    REQUIRE(not_x::value.has_nibbles);
+    REQUIRE(verify_nibbles<not_x>());
+    REQUIRE(alnum::value.has_nibbles);
+    REQUIRE(verify_nibbles<alnum>());
+    REQUIRE(blank_or_x::value.has_nibbles);
+    REQUIRE(verify_nibbles<blank_or_x>());
+    REQUIRE(!multiple_of_17::value.has_nibbles);
+
+    for (auto length : {0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 64u, 100u})
+    {
+        INFO(length);
+
+        auto run = std::string(length, ' ');
+        for (auto i = 0u; i < length; i += 3)
+            run[i] = '\t';
+
+        REQUIRE(skip<blank>(run) == length);
+        REQUIRE(skip<blank>(run + "a") == length);
+        REQUIRE(skip<blank>(run + "a   ") == length);
+
+        auto digits = std::string(length, '7') + " ";
+        REQUIRE(skip<digit>(digits) == length);
+
+        auto others = std::string(length, '\xFF') + "x";
+        REQUIRE(skip<not_x>(others) == length);
+
+        auto text = std::string(length, 'a') + "\t";
+        REQUIRE(skip<not_blank>(text) == length);
+        REQUIRE(skip<not_blank>(text + "a") == length);
+
+        auto identifier = std::string(length, 'a');
+        for (auto i = 0u; i < length; i += 5)
+            identifier[i] = "_Z9q"[i % 4];
+        REQUIRE(skip<alnum>(identifier + "+") == length);
+        REQUIRE(skip<alnum>(identifier + "\x80") == length);
+
+        auto multiples = std::string(length, '\x11') + "a";
+        REQUIRE(skip<multiple_of_17>(multiples) == length);
+    }
+
+    constexpr auto result = skip_constexpr(" \t   \t                                      a");
+    REQUIRE(result == 44);
+}
@@ -0,0 +1,128 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/detail/dfa.hpp>
+
+#include <catch.hpp>
+#include <cstring>
+#include <foonathan/lex/detail/trie.hpp>
+
+using namespace foonathan::lex;
+
+namespace
+{
+// actual types don't matter for the trie, just the id
+using tokens = token_spec<struct a, struct ab, struct abcd, struct bc, struct digits, struct bcd>;
+struct a
+{};
+struct ab
+{};
+struct abcd
+{};
+struct bc
+{};
+struct digits
+{};
+struct bcd
+{};
+
+template <typename T>
+constexpr token_kind_detail::id_type<tokens> id_of()
+{
+    return token_kind<tokens>(T{}).get();
+}
+
+// matches a sequence of digits
+struct digits_rule
+{
+    static constexpr match_result<tokens> try_match(const char* str, const char* end) noexcept
+    {
+        auto cur = str;
+        while (cur != end && *cur >= '0' && *cur <= '9')
+            ++cur;
+        if (cur == str)
+            return match_result<tokens>::unmatched();
+        return match_result<tokens>::success(digits{}, static_cast<std::size_t>(cur - str));
+    }
+
+    static constexpr bool is_conflicting_literal(token_kind<tokens>) noexcept
+    {
+        return false;
+    }
+};
+
+// matches `bc` followed by a `d`, but errors on `bcx`
+struct bcd_rule
+{
+    static constexpr match_result<tokens> try_match(const char* str, const char* end) noexcept
+    {
+        if (end - str >= 3 && str[0] == 'b' && str[1] == 'c')
+        {
+            if (str[2] == 'd')
+                return match_result<tokens>::success(bcd{}, 3);
+            else if (str[2] == 'x')
+                return match_result<tokens>::error(3);
+        }
+        return match_result<tokens>::unmatched();
+    }
+
+    static constexpr bool is_conflicting_literal(token_kind<tokens> kind) noexcept
+    {
+        return kind == bc{};
+    }
+};
+
+using test_trie = detail::trie<tokens>;
+
+template <class Trie>
+struct build_impl
+{
+    using first  = test_trie::insert_literal<Trie, id_of<a>(), 'a'>;
+    using second = test_trie::insert_literal<first, id_of<ab>(), 'a', 'b'>;
+    using third  = test_trie::insert_literal<second, id_of<abcd>(), 'a', 'b', 'c', 'd'>;
+    using fourth = test_trie::insert_literal<third, id_of<bc>(), 'b', 'c'>;
+    using fifth  = test_trie::insert_rule<fourth, digits_rule>;
+    using sixth  = test_trie::insert_rule<fifth, bcd_rule>;
+    using type   = sixth;
+};
+
+using trie = typename build_impl<test_trie::empty>::type;
+using dfa  = detail::dfa<tokens, trie>;
+
+void verify(const char* str)
+{
+    INFO(str);
+    auto size     = std::strlen(str);
+    auto expected = trie::try_match(str, size);
+    auto actual   = dfa::try_match(str, size);
+    REQUIRE(actual.kind == expected.kind);
+    REQUIRE(actual.bump == expected.bump);
+}
+
+constexpr auto test_lookup(const char* str, std::size_t size)
+{
+    return dfa::try_match(str, size);
+}
+} // namespace
+
+TEST_CASE("detail::dfa")
+{
+    REQUIRE(dfa::try_match("", std::size_t(0)).is_eof());
+
+    REQUIRE(dfa::try_match("a", 1).kind.is<a>());
+    REQUIRE(dfa::try_match("abc", 3).kind.is<ab>());
+    REQUIRE(dfa::try_match("abcd", 4).kind.is<abcd>());
+    REQUIRE(dfa::try_match("bcd", 3).kind.is<bcd>());
+    REQUIRE(dfa::try_match("bcx", 3).is_error());
+    REQUIRE(dfa::try_match("123a", 4).kind.is<digits>());
+    REQUIRE(dfa::try_match("x", 1).is_error());
+
+    for (auto str : {"a", "aa", "ab", "abc", "abcd", "abcde", "abx", "b", "bc", "bcd", "bcx", "bcc",
+                     "bx", "c", "1", "123", "12a", "x", "\xFF", "abcx"})
+        verify(str);
+
+    constexpr auto result = test_lookup("abcd", 4);
+    REQUIRE(result.kind.is<abcd>());
+    REQUIRE(result.bump == 4);
+}
@@ -0,0 +1,70 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/detail/keyword_hash.hpp>
+
+#include <catch.hpp>
+#include <cstring>
+#include <foonathan/lex/identifier_token.hpp>
+
+using namespace foonathan::lex;
+
+namespace
+{
+// abc, axc and acc can't be distinguished by the hash function
+using tokens = token_spec<struct kw_a, struct kw_abc, struct kw_axc, struct kw_acc, struct kw_while,
+                          struct kw_int, struct kw_if>;
+
+struct kw_a : keyword_token<'a'>
+{};
+struct kw_abc : FOONATHAN_LEX_KEYWORD("abc")
+{};
+struct kw_axc : FOONATHAN_LEX_KEYWORD("axc")
+{};
+struct kw_acc : FOONATHAN_LEX_KEYWORD("acc")
+{};
+struct kw_while : FOONATHAN_LEX_KEYWORD("while")
+{};
+struct kw_int : FOONATHAN_LEX_KEYWORD("int")
+{};
+struct kw_if : FOONATHAN_LEX_KEYWORD("if")
+{};
+
+using table = detail::keyword_hash_table<tokens, tokens>;
+
+match_result<tokens> match(const char* str)
+{
+    return table::try_match(str, std::strlen(str));
+}
+} // namespace
+
+TEST_CASE("detail::keyword_hash_table")
+{
+    REQUIRE(match("a").kind.is<kw_a>());
+    REQUIRE(match("abc").kind.is<kw_abc>());
+    REQUIRE(match("axc").kind.is<kw_axc>());
+    REQUIRE(match("acc").kind.is<kw_acc>());
+    REQUIRE(match("while").kind.is<kw_while>());
+    REQUIRE(match("int").kind.is<kw_int>());
+    REQUIRE(match("if").kind.is<kw_if>());
+    REQUIRE(match("while").bump == 5);
+
+    // same hash as a keyword
+    REQUIRE(match("ayc").is_unmatched());
+    REQUIRE(match("iff").is_unmatched());
+    // prefix or extension of a keyword
+    REQUIRE(match("ab").is_unmatched());
+    REQUIRE(match("whil").is_unmatched());
+    REQUIRE(match("integer").is_unmatched());
+    // longer than all keywords
+    REQUIRE(match("whilewhile").is_unmatched());
+    // no keyword starts with the character
+    REQUIRE(match("xyz").is_unmatched());
+    REQUIRE(!table::is_candidate("xyz", 3));
+    REQUIRE(!table::is_candidate("whilewhile", 10));
+    REQUIRE(table::is_candidate("ayc", 3));
+
+    constexpr auto result = table::try_match("int", 3);
+    REQUIRE(result.kind.is<kw_int>());
+}
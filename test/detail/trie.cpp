@@ -12,7 +12,8 @@ using namespace foonathan::lex;
 namespace
 {
 // actual types don't matter for the trie, just the id
-using tokens = token_spec<struct a, struct b, struct c, struct ab, struct abcd, struct bc>;
+using tokens = token_spec<struct a, struct b, struct c, struct ab, struct abcd, struct bc, struct d,
+                          struct e, struct da, struct db, struct dc, struct dd, struct de>;
 struct a
 {};
 struct b
@@ -25,6 +26,20 @@ struct abcd
 {};
 struct bc
 {};
+struct d
+{};
+struct e
+{};
+struct da
+{};
+struct db
+{};
+struct dc
+{};
+struct dd
+{};
+struct de
+{};
 
 template <typename T>
 constexpr token_kind_detail::id_type<tokens> id_of()
@@ -67,6 +82,22 @@ struct insert_multiple_impl
 template <class Trie>
 using insert_multiple = typename insert_multiple_impl<Trie>::type;
 
+template <class Trie>
+struct insert_wide_impl
+{
+    using first   = test_trie::insert_literal<Trie, id_of<d>(), 'd'>;
+    using second  = test_trie::insert_literal<first, id_of<e>(), 'e'>;
+    using third   = test_trie::insert_literal<second, id_of<da>(), 'd', 'a'>;
+    using fourth  = test_trie::insert_literal<third, id_of<db>(), 'd', 'b'>;
+    using fifth   = test_trie::insert_literal<fourth, id_of<dc>(), 'd', 'c'>;
+    using sixth   = test_trie::insert_literal<fifth, id_of<dd>(), 'd', 'd'>;
+    using seventh = test_trie::insert_literal<sixth, id_of<de>(), 'd', 'e'>;
+    using type    = seventh;
+};
+
+template <class Trie>
+using insert_wide = typename insert_wide_impl<Trie>::type;
+
 template <class Trie>
 constexpr auto test_lookup(Trie)
 {
@@ -100,4 +131,69 @@ TEST_CASE("detail::trie")
 
     constexpr auto result = test_lookup(trie2{});
     REQUIRE(result.is<a>());
+
+    // root and 'd' node have enough children to use the dispatch table
+    using trie3 = insert_wide<trie2>;
+    verify<a>(trie3{}, "a", "a");
+    verify<abcd>(trie3{}, "abcd", "abcd");
+    verify<c>(trie3{}, "cd", "c");
+    verify<d>(trie3{}, "d", "d");
+    verify<d>(trie3{}, "df", "d");
+    verify<de>(trie3{}, "de", "de");
+    verify<da>(trie3{}, "da", "da");
+    verify<dd>(trie3{}, "dda", "dd");
+    verify<e>(trie3{}, "e", "e");
+    REQUIRE(trie3::try_match("f", 1).is_error());
+    REQUIRE(trie3::try_match("\xFF", 1).is_error());
+
+    constexpr auto wide_result = test_lookup(trie3{});
+    REQUIRE(wide_result.is<a>());
+}
+
+namespace
+{
+// the literals of insert_single, insert_multiple and insert_wide, in a different order
+struct literal_list
+{
+    static constexpr std::size_t count = 13;
+
+    static constexpr const char* strings[count] = {"de", "abcd", "a", "dd", "bc", "e", "ab",
+                                                   "d",  "c",    "b", "da", "db", "dc"};
+    static constexpr std::size_t lengths[count] = {2, 4, 1, 2, 2, 1, 2, 1, 1, 1, 2, 2, 2};
+    static constexpr token_kind_detail::id_type<tokens> ids[count]
+        = {id_of<de>(), id_of<abcd>(), id_of<a>(), id_of<dd>(), id_of<bc>(),
+           id_of<e>(),  id_of<ab>(),   id_of<d>(), id_of<c>(),  id_of<b>(),
+           id_of<da>(), id_of<db>(),   id_of<dc>()};
+};
+
+constexpr const char*                        literal_list::strings[];
+constexpr std::size_t                        literal_list::lengths[];
+constexpr token_kind_detail::id_type<tokens> literal_list::ids[];
+} // namespace
+
+TEST_CASE("detail::trie::build")
+{
+    using trie = test_trie::build<literal_list>;
+    verify<a>(trie{}, "a", "a");
+    verify<ab>(trie{}, "ab", "ab");
+    verify<ab>(trie{}, "abc", "ab");
+    verify<abcd>(trie{}, "abcd", "abcd");
+    verify<b>(trie{}, "b", "b");
+    verify<bc>(trie{}, "bcd", "bc");
+    verify<c>(trie{}, "cd", "c");
+    verify<d>(trie{}, "d", "d");
+    verify<d>(trie{}, "df", "d");
+    verify<da>(trie{}, "da", "da");
+    verify<dd>(trie{}, "dda", "dd");
+    verify<de>(trie{}, "de", "de");
+    verify<e>(trie{}, "e", "e");
+    REQUIRE(trie::try_match("f", 1).is_error());
+    REQUIRE(trie::try_match("\xFF", 1).is_error());
+
+    // same children as when inserting them one by one
+    using inserted = insert_wide<insert_multiple<insert_single<test_trie::empty>>>;
+    static_assert(trie::children::size == inserted::children::size, "");
+
+    constexpr auto result = test_lookup(trie{});
+    REQUIRE(result.is<a>());
 }
@@ -0,0 +1,13 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "extern_grammar.hpp"
+
+// the only translation unit that matches and parses inline,
+// the tests in tokenizer.cpp and production_rule_production.cpp link against it
+namespace extern_grammar
+{
+FOONATHAN_LEX_DEFINE_TOKENIZER(spec);
+FOONATHAN_LEX_DEFINE_PARSER(grammar, visitor);
+} // namespace extern_grammar
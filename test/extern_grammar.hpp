@@ -0,0 +1,80 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_LEX_EXTERN_GRAMMAR_HPP_INCLUDED
+#define FOONATHAN_LEX_EXTERN_GRAMMAR_HPP_INCLUDED
+
+#include <type_traits>
+
+#include <foonathan/lex/list_production.hpp>
+#include <foonathan/lex/parser.hpp>
+#include <foonathan/lex/rule_production.hpp>
+#include <foonathan/lex/tokenizer.hpp>
+
+// a token specification and grammar that are only declared here,
+// the tokenizer and parser are defined in extern_grammar.cpp
+namespace extern_grammar
+{
+namespace lex = foonathan::lex;
+
+struct spec : lex::token_spec<struct token_a, struct token_bc>
+{
+    static constexpr bool extern_tokenizer = true;
+};
+
+struct token_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct token_bc : FOONATHAN_LEX_LITERAL("bc")
+{};
+
+using grammar = lex::grammar<spec, struct list, struct pair>;
+
+struct list : lex::list_production<list, grammar>
+{
+    using element     = pair;
+    using end_token   = lex::eof_token;
+    using allow_empty = std::true_type;
+};
+
+struct pair : lex::rule_production<pair, grammar>
+{
+    static constexpr auto rule()
+    {
+        using namespace lex::production_rule;
+        return token_a{} + token_bc{};
+    }
+};
+
+// counts the pairs
+struct visitor
+{
+    static constexpr bool extern_parser = true;
+
+    int operator()(lex::callback_result_of<list>) const;
+
+    int operator()(list) const
+    {
+        return 0;
+    }
+    int operator()(list, int count, int value) const
+    {
+        return count + value;
+    }
+
+    int operator()(pair, lex::static_token<token_a>, lex::static_token<token_bc>) const
+    {
+        return 1;
+    }
+
+    template <class Error>
+    void operator()(Error, const lex::tokenizer<spec>&) const
+    {}
+};
+
+FOONATHAN_LEX_DECLARE_TOKENIZER(spec);
+FOONATHAN_LEX_DECLARE_PARSER(grammar, visitor);
+} // namespace extern_grammar
+
+#endif // FOONATHAN_LEX_EXTERN_GRAMMAR_HPP_INCLUDED
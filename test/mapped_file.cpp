@@ -0,0 +1,135 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/mapped_file.hpp>
+
+#include <catch.hpp>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "tokenize.hpp"
+
+namespace
+{
+using test_spec = lex::token_spec<struct token_a, struct token_bc>;
+
+struct token_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct token_bc : FOONATHAN_LEX_LITERAL("bc")
+{};
+
+void write_file(const char* path, const std::string& contents)
+{
+    auto file = std::fopen(path, "wb");
+    REQUIRE(file);
+    REQUIRE(std::fwrite(contents.data(), 1, contents.size(), file) == contents.size());
+    std::fclose(file);
+}
+} // namespace
+
+TEST_CASE("mapped_file")
+{
+    auto path = "foonathan_lex_mapped_file_test.txt";
+
+    SECTION("no file")
+    {
+        lex::mapped_file file;
+        REQUIRE(!file);
+        REQUIRE(file.size() == 0);
+
+        file = lex::mapped_file("foonathan_lex_mapped_file_test_does_not_exist.txt");
+        REQUIRE(!file.is_open());
+    }
+    SECTION("empty file")
+    {
+        write_file(path, "");
+
+        lex::mapped_file file(path);
+        REQUIRE(file);
+        REQUIRE(file.size() == 0);
+        REQUIRE(file.begin() == file.end());
+
+        lex::tokenizer<test_spec> tokenizer(file.begin(), file.end());
+        REQUIRE(tokenizer.is_done());
+    }
+    SECTION("tokenize")
+    {
+        write_file(path, "abca");
+
+        lex::mapped_file file(path);
+        REQUIRE(file);
+        REQUIRE(file.size() == 4);
+        REQUIRE(std::string(file.data(), file.size()) == "abca");
+
+        // moving keeps the mapping
+        auto moved = std::move(file);
+        REQUIRE(!file);
+        REQUIRE(moved.size() == 4);
+
+        lex::tokenizer<test_spec> tokenizer(moved.begin(), moved.end());
+        REQUIRE(tokenizer.get().is(token_a{}));
+
+        auto bc = tokenizer.get();
+        REQUIRE(bc.is(token_bc{}));
+        REQUIRE(bc.spelling().data() == moved.data() + 1);
+
+        REQUIRE(tokenizer.get().is(token_a{}));
+        REQUIRE(tokenizer.is_done());
+    }
+#if FOONATHAN_LEX_DETAIL_HAS_MMAP
+    SECTION("directory")
+    {
+        lex::mapped_file file(".");
+        REQUIRE(!file);
+    }
+    SECTION("pipe")
+    {
+        // a pipe has no size, so it has to be read
+        REQUIRE(::mkfifo(path, 0600) == 0);
+        std::thread writer([&] {
+            // opening blocks until the file is opened for reading as well
+            auto file = std::fopen(path, "wb");
+            if (file)
+            {
+                std::fputs("abca", file);
+                std::fclose(file);
+            }
+        });
+
+        lex::mapped_file file(path);
+        writer.join();
+        REQUIRE(file);
+        REQUIRE(std::string(file.data(), file.size()) == "abca");
+
+        auto moved = std::move(file);
+        REQUIRE(moved.size() == 4);
+    }
+#endif
+#if defined(__linux__)
+    SECTION("unmappable file")
+    {
+        // a sysfs attribute has a size but can't be mapped
+        auto sysfs = "/sys/kernel/cpu_byteorder";
+
+        std::string contents;
+        if (auto expected = std::fopen(sysfs, "rb"))
+        {
+            for (auto c = std::fgetc(expected); c != EOF; c = std::fgetc(expected))
+                contents += static_cast<char>(c);
+            std::fclose(expected);
+        }
+
+        lex::mapped_file file(sysfs);
+        if (!contents.empty())
+        {
+            REQUIRE(file);
+            REQUIRE(std::string(file.data(), file.size()) == contents);
+        }
+    }
+#endif
+
+    std::remove(path);
+}
@@ -13,8 +13,20 @@
 
 namespace lex = foonathan::lex;
 
+// operator_production_climbing.cpp runs all tests again with the other engine
+#ifndef FOONATHAN_LEX_TEST_ENGINE
+#    define FOONATHAN_LEX_TEST_ENGINE recursive_descent_engine
+#    define FOONATHAN_LEX_TEST_NAME(Name) "operator_production: " Name
+#endif
+
 namespace
 {
+template <class Derived, class Grammar>
+struct operator_production : lex::operator_production<Derived, Grammar>
+{
+    using engine = lex::operator_rule::FOONATHAN_LEX_TEST_ENGINE;
+};
+
 using test_spec
     = lex::token_spec<struct whitespace, struct number, struct plus, struct minus, struct star,
                       struct exclamation, struct paren_open, struct paren_close>;
@@ -80,10 +92,26 @@ void verify(const lex::parse_result<int>& result, int expected)
 }
 } // namespace
 
-TEST_CASE("operator_production: pre_op_single")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("operator_table"))
+{
+    using lex::detail::type_list;
+    using table = lex::operator_rule::detail::operator_table<test_spec, type_list<star>,
+                                                             type_list<plus, minus>,
+                                                             type_list<minus>>;
+    auto lookup = [](auto token) {
+        return table::value.group[lex::token_kind<test_spec>(token).get()];
+    };
+    REQUIRE(lookup(star{}) == 0);
+    REQUIRE(lookup(plus{}) == 1);
+    REQUIRE(lookup(minus{}) == 1);
+    REQUIRE(lookup(number{}) == 3);
+    REQUIRE(lookup(lex::eof_token{}) == 3);
+}
+
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("pre_op_single"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -143,10 +171,10 @@ TEST_CASE("operator_production: pre_op_single")
     verify(r6, unmatched);
 }
 
-TEST_CASE("operator_production: pre_op_chain")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("pre_op_chain"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -209,10 +237,10 @@ TEST_CASE("operator_production: pre_op_chain")
     verify(r7, unmatched);
 }
 
-TEST_CASE("operator_production: post_op_single")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("post_op_single"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -272,10 +300,10 @@ TEST_CASE("operator_production: post_op_single")
     verify(r6, unmatched);
 }
 
-TEST_CASE("operator_production: post_op_chain")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("post_op_chain"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -338,10 +366,10 @@ TEST_CASE("operator_production: post_op_chain")
     verify(r7, unmatched);
 }
 
-TEST_CASE("operator_production: bin_op_single")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("bin_op_single"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -430,10 +458,10 @@ TEST_CASE("operator_production: bin_op_single")
     verify(r8, unmatched);
 }
 
-TEST_CASE("operator_production: bin_op_single + pre_op_single")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("bin_op_single + pre_op_single"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -499,10 +527,10 @@ TEST_CASE("operator_production: bin_op_single + pre_op_single")
     verify(r6, unmatched);
 }
 
-TEST_CASE("operator_production: pre_op_single + bin_op_single")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("pre_op_single + bin_op_single"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -559,10 +587,10 @@ TEST_CASE("operator_production: pre_op_single + bin_op_single")
     verify(r5, unmatched);
 }
 
-TEST_CASE("operator_production: bin_op_single + post_op_single")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("bin_op_single + post_op_single"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -628,10 +656,10 @@ TEST_CASE("operator_production: bin_op_single + post_op_single")
     verify(r6, unmatched);
 }
 
-TEST_CASE("operator_production: post_op_single + bin_op_single")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("post_op_single + bin_op_single"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -688,10 +716,10 @@ TEST_CASE("operator_production: post_op_single + bin_op_single")
     verify(r5, unmatched);
 }
 
-TEST_CASE("operator_production: bin_op_left")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("bin_op_left"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -748,10 +776,10 @@ TEST_CASE("operator_production: bin_op_left")
     verify(r5, unmatched);
 }
 
-TEST_CASE("operator_production: bin_op_right")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("bin_op_right"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -808,10 +836,10 @@ TEST_CASE("operator_production: bin_op_right")
     verify(r5, unmatched);
 }
 
-TEST_CASE("operator_production: parenthesized")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("parenthesized"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -878,10 +906,10 @@ TEST_CASE("operator_production: parenthesized")
     verify(r7, unmatched);
 }
 
-TEST_CASE("operator_production: choice with single atom")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("choice with single atom"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -945,10 +973,10 @@ TEST_CASE("operator_production: choice with single atom")
     verify(r5, unmatched);
 }
 
-TEST_CASE("operator_production: choice with unary")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("choice with unary"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
@@ -1013,7 +1041,134 @@ TEST_CASE("operator_production: choice with unary")
     verify(r5, unmatched);
 }
 
-TEST_CASE("operator_production: production as operator")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("choice with postfix operand"))
+{
+    using grammar = lex::grammar<test_spec, struct P>;
+    struct P : operator_production<P, grammar>
+    {
+        static constexpr auto rule()
+        {
+            namespace r = lex::operator_rule;
+
+            auto atom = r::atom<number>;
+
+            auto multiplication = r::bin_op_left<star>(atom);
+
+            // the post operators of a choice must be unique,
+            // so the exclamation mark decides for the addition
+            auto not_     = r::post_op_single<exclamation>(atom);
+            auto addition = r::bin_op_left<plus>(not_);
+
+            return multiplication / addition;
+        }
+    };
+
+    struct visitor
+    {
+        int operator()(lex::callback_result_of<P>) const;
+
+        constexpr int operator()(P, lex::static_token<number> num) const
+        {
+            return number::parse(num);
+        }
+
+        constexpr int operator()(P, int lhs, star, int rhs) const
+        {
+            return lhs * rhs;
+        }
+
+        constexpr int operator()(P, int lhs, plus, int rhs) const
+        {
+            return lhs + rhs;
+        }
+
+        constexpr int operator()(P, int value, exclamation) const
+        {
+            return !value;
+        }
+
+        constexpr void operator()(lex::unexpected_token<grammar, P, number>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+    };
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r0 = parse<P>(visitor{}, "2 * 3");
+    verify(r0, 6);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r1 = parse<P>(visitor{}, "1 + 2");
+    verify(r1, 3);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r2 = parse<P>(visitor{}, "0!");
+    verify(r2, 1);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r3 = parse<P>(visitor{}, "0! + 2! + 3");
+    verify(r3, 4);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r4 = parse<P>(visitor{}, "0! * 3");
+    verify(r4, unmatched);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r5 = parse<P>(visitor{}, "2 * 3!");
+    verify(r5, unmatched);
+}
+
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("bin_op_single after pre_op_single"))
+{
+    using grammar = lex::grammar<test_spec, struct P>;
+    struct P : operator_production<P, grammar>
+    {
+        static constexpr auto rule()
+        {
+            namespace r = lex::operator_rule;
+
+            auto atom     = r::atom<number>;
+            auto addition = r::bin_op_single<plus>(atom);
+            auto negate   = r::pre_op_single<minus>(addition);
+            return negate;
+        }
+    };
+
+    struct visitor
+    {
+        int operator()(lex::callback_result_of<P>) const;
+
+        constexpr int operator()(P, lex::static_token<number> num) const
+        {
+            return number::parse(num);
+        }
+
+        constexpr int operator()(P, int lhs, plus, int rhs) const
+        {
+            return lhs + rhs;
+        }
+
+        constexpr int operator()(P, minus, int value) const
+        {
+            return -value;
+        }
+
+        constexpr void operator()(lex::unexpected_token<grammar, P, number>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+    };
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r0 = parse<P>(visitor{}, "1 + 2");
+    verify(r0, 3);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r1 = parse<P>(visitor{}, "1 + 2 + 3");
+    verify(r1, unmatched);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r2 = parse<P>(visitor{}, "-1 + 2");
+    verify(r2, -3);
+
+    // the negation is done, so the addition can be used again
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r3 = parse<P>(visitor{}, "-1 + 2 + 3");
+    verify(r3, 0);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r4 = parse<P>(visitor{}, "--1");
+    verify(r4, unmatched);
+}
+
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("production as operator"))
 {
     SECTION("pre_prod_single")
     {
@@ -1026,7 +1181,7 @@ TEST_CASE("operator_production: production as operator")
             }
         };
 
-        struct P : lex::operator_production<P, grammar>
+        struct P : operator_production<P, grammar>
         {
             static FOONATHAN_LEX_TEST_CONSTEXPR auto rule()
             {
@@ -1085,7 +1240,7 @@ TEST_CASE("operator_production: production as operator")
             }
         };
 
-        struct P : lex::operator_production<P, grammar>
+        struct P : operator_production<P, grammar>
         {
             static constexpr auto rule()
             {
@@ -1144,7 +1299,7 @@ TEST_CASE("operator_production: production as operator")
             }
         };
 
-        struct P : lex::operator_production<P, grammar>
+        struct P : operator_production<P, grammar>
         {
             static constexpr auto rule()
             {
@@ -1203,7 +1358,7 @@ TEST_CASE("operator_production: production as operator")
             }
         };
 
-        struct P : lex::operator_production<P, grammar>
+        struct P : operator_production<P, grammar>
         {
             static constexpr auto rule()
             {
@@ -1262,7 +1417,7 @@ TEST_CASE("operator_production: production as operator")
             }
         };
 
-        struct P : lex::operator_production<P, grammar>
+        struct P : operator_production<P, grammar>
         {
             static constexpr auto rule()
             {
@@ -1321,7 +1476,7 @@ TEST_CASE("operator_production: production as operator")
             }
         };
 
-        struct P : lex::operator_production<P, grammar>
+        struct P : operator_production<P, grammar>
         {
             static constexpr auto rule()
             {
@@ -1380,7 +1535,7 @@ TEST_CASE("operator_production: production as operator")
             }
         };
 
-        struct P : lex::operator_production<P, grammar>
+        struct P : operator_production<P, grammar>
         {
             static constexpr auto rule()
             {
@@ -1430,10 +1585,10 @@ TEST_CASE("operator_production: production as operator")
     }
 }
 
-TEST_CASE("operator_production: end")
+TEST_CASE(FOONATHAN_LEX_TEST_NAME("end"))
 {
     using grammar = lex::grammar<test_spec, struct P>;
-    struct P : lex::operator_production<P, grammar>
+    struct P : operator_production<P, grammar>
     {
         static constexpr auto rule()
         {
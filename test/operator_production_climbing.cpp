@@ -0,0 +1,9 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// runs the tests of operator_production.cpp using the precedence climbing engine
+#define FOONATHAN_LEX_TEST_ENGINE precedence_climbing_engine
+#define FOONATHAN_LEX_TEST_NAME(Name) "operator_production (precedence climbing): " Name
+
+#include "operator_production.cpp"
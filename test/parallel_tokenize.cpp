@@ -0,0 +1,101 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/parallel_tokenize.hpp>
+
+#include <catch.hpp>
+#include <string>
+
+#include "test.hpp"
+#include <foonathan/lex/ascii.hpp>
+
+namespace
+{
+namespace lex = foonathan::lex;
+
+using test_spec = lex::token_spec<struct whitespace, struct string, struct digits, struct token_a,
+                                  struct token_ab, struct token_abc>;
+
+struct whitespace : lex::rule_token<whitespace, test_spec>, lex::whitespace_token
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::star(lex::ascii::is_space);
+    }
+};
+
+// strings can contain anything, so a chunk starting inside one is tokenized wrongly at first
+struct string : lex::rule_token<string, test_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return '"' + lex::token_rule::until('"');
+    }
+};
+
+struct digits : lex::rule_token<digits, test_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::plus(lex::ascii::is_digit);
+    }
+};
+
+struct token_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct token_ab : FOONATHAN_LEX_LITERAL("ab")
+{};
+
+struct token_abc : FOONATHAN_LEX_LITERAL("abc")
+{};
+
+std::vector<lex::token<test_spec>> tokenize(const std::string& input)
+{
+    std::vector<lex::token<test_spec>> result;
+    for (lex::tokenizer<test_spec> tokenizer(input.data(), input.size()); !tokenizer.is_done();)
+        result.push_back(tokenizer.get());
+    return result;
+}
+
+void verify(const std::string& input, std::size_t threads)
+{
+    INFO(threads);
+
+    auto expected = tokenize(input);
+    auto actual   = lex::parallel_tokenize<test_spec>(input.data(), input.data() + input.size(),
+                                                    threads);
+    REQUIRE(actual.size() == expected.size());
+    for (auto i = 0u; i != actual.size(); ++i)
+    {
+        INFO(i);
+        REQUIRE(actual[i].kind() == expected[i].kind());
+        REQUIRE(actual[i].spelling().data() == expected[i].spelling().data());
+        REQUIRE(actual[i].spelling().size() == expected[i].spelling().size());
+    }
+}
+} // namespace
+
+TEST_CASE("parallel_tokenize")
+{
+    SECTION("empty")
+    {
+        verify("", 4);
+    }
+    SECTION("short")
+    {
+        for (auto threads = 0u; threads != 16u; ++threads)
+            verify("abc ab\"a b c\" 123", threads);
+    }
+    SECTION("long")
+    {
+        std::string input;
+        for (auto i = 0; i != 100; ++i)
+            input += "abcab 12 \"ab 12 abc\" aaa  x\n\"\"abab ";
+        input += '"' + std::string(500, 'a') + "\" abc";
+
+        for (auto threads = 1u; threads != 33u; ++threads)
+            verify(input, threads);
+    }
+}
@@ -0,0 +1,210 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/parse_memo.hpp>
+
+#include <catch.hpp>
+#include <string>
+#include <vector>
+
+#include <foonathan/lex/ascii.hpp>
+#include <foonathan/lex/list_production.hpp>
+#include <foonathan/lex/operator_production.hpp>
+#include <foonathan/lex/rule_production.hpp>
+
+namespace lex = foonathan::lex;
+
+namespace
+{
+using test_spec = lex::token_spec<struct whitespace, struct number, struct name, struct equal,
+                                  struct plus, struct semicolon>;
+
+struct whitespace : lex::rule_token<whitespace, test_spec>, lex::whitespace_token
+{
+    static constexpr auto rule()
+    {
+        return lex::token_rule::star(lex::ascii::is_space);
+    }
+};
+
+struct number : lex::rule_token<number, test_spec>
+{
+    static constexpr auto rule()
+    {
+        return lex::token_rule::plus(lex::ascii::is_digit);
+    }
+
+    static int parse(lex::static_token<number> token)
+    {
+        auto result = 0;
+        for (auto c : token.spelling())
+            result = result * 10 + (c - '0');
+        return result;
+    }
+};
+
+struct name : lex::rule_token<name, test_spec>
+{
+    static constexpr auto rule()
+    {
+        return lex::token_rule::plus(lex::ascii::is_alpha);
+    }
+};
+
+struct equal : lex::literal_token<'='>
+{};
+struct plus : lex::literal_token<'+'>
+{};
+struct semicolon : lex::literal_token<';'>
+{};
+
+using grammar = lex::grammar<test_spec, struct file, struct statement, struct expr>;
+
+struct file : lex::list_production<file, grammar>
+{
+    using element     = statement;
+    using end_token   = lex::eof_token;
+    using allow_empty = std::true_type;
+};
+
+struct expr : lex::operator_production<expr, grammar>
+{
+    static constexpr auto rule()
+    {
+        namespace r = lex::operator_rule;
+        return r::bin_op_left<plus>(r::atom<number>);
+    }
+};
+
+struct statement : lex::rule_production<statement, grammar>
+{
+    static constexpr auto rule()
+    {
+        using namespace lex::production_rule;
+        return name{} + equal{} + expr{} + semicolon{};
+    }
+};
+
+struct visitor
+{
+    // the number of statements that have been parsed
+    int statements = 0;
+
+    int operator()(lex::callback_result_of<expr>) const;
+
+    int operator()(expr, lex::static_token<number> n) const
+    {
+        return number::parse(n);
+    }
+    int operator()(expr, int lhs, plus, int rhs) const
+    {
+        return lhs + rhs;
+    }
+
+    int operator()(statement, lex::static_token<name>, lex::static_token<equal>, int value,
+                   lex::static_token<semicolon>)
+    {
+        ++statements;
+        return value;
+    }
+
+    std::vector<int> operator()(file) const
+    {
+        return {};
+    }
+    std::vector<int> operator()(file, std::vector<int> list, int value) const
+    {
+        list.push_back(value);
+        return list;
+    }
+
+    template <class Error>
+    void operator()(Error, const lex::tokenizer<test_spec>&) const
+    {}
+};
+
+std::vector<int> parse(const std::string& input)
+{
+    lex::tokenizer<test_spec> tokenizer(input.data(), input.size());
+    visitor                   v;
+    auto                      result = lex::parse<grammar>(tokenizer, v);
+    REQUIRE(result.is_success());
+    return result.value();
+}
+
+// parses the input after the edit, returns the number of statements that were parsed again
+int reparse(std::string& input, lex::parse_memo<grammar>& memo, std::size_t offset,
+            std::size_t length, const std::string& replacement)
+{
+    INFO(input);
+    input.replace(offset, length, replacement);
+    memo.apply(lex::text_edit{offset, length, replacement.size()});
+    INFO(input);
+
+    lex::tokenizer<test_spec> tokenizer(input.data(), input.size());
+    visitor                   v;
+    auto                      result = lex::parse<grammar>(tokenizer, v, memo);
+    REQUIRE(result.is_success());
+    REQUIRE(result.value() == parse(input));
+    return v.statements;
+}
+} // namespace
+
+TEST_CASE("parse_memo")
+{
+    std::string input;
+    for (auto i = 0; i != 100; ++i)
+        input += "x = " + std::to_string(i) + " + 1;\n";
+
+    lex::parse_memo<grammar> memo;
+    REQUIRE(reparse(input, memo, 0, 0, "") == 100);
+    REQUIRE(memo.reused() == 0);
+    REQUIRE(memo.size() > 0u);
+
+    SECTION("no edit")
+    {
+        REQUIRE(reparse(input, memo, 0, 0, "") == 0);
+        REQUIRE(memo.reused() == 1u);
+    }
+    SECTION("edit inside a statement")
+    {
+        auto offset = input.find("x = 50");
+        REQUIRE(reparse(input, memo, offset + 4, 2, "4 + 2") == 1);
+        REQUIRE(memo.reused() == 99u);
+
+        // and again
+        REQUIRE(reparse(input, memo, offset + 4, 4, "") == 1);
+        REQUIRE(memo.reused() == 99u);
+    }
+    SECTION("edit between statements")
+    {
+        auto offset = input.find("x = 50");
+        // the statement before has to be parsed again, as the token after it has changed
+        REQUIRE(reparse(input, memo, offset, 0, "y = 1 + 1 + 1; ") == 2);
+        REQUIRE(memo.reused() == 100u);
+    }
+    SECTION("edit at the beginning")
+    {
+        // the expression of the statement can still be reused
+        REQUIRE(reparse(input, memo, 0, 1, "abc") == 1);
+        REQUIRE(memo.reused() == 100u);
+    }
+    SECTION("edit at the end")
+    {
+        REQUIRE(reparse(input, memo, input.size(), 0, "y = 0;") == 2);
+        REQUIRE(memo.reused() == 100u);
+    }
+    SECTION("erase statements")
+    {
+        auto begin = input.find("x = 10");
+        auto end   = input.find("x = 20");
+        REQUIRE(reparse(input, memo, begin, end - begin, "") == 1);
+        REQUIRE(memo.reused() == 90u);
+    }
+    SECTION("erase everything")
+    {
+        REQUIRE(reparse(input, memo, 0, input.size(), "") == 0);
+        REQUIRE(memo.size() == 1u);
+    }
+}
@@ -6,6 +6,7 @@
 
 #include <catch.hpp>
 
+#include "extern_grammar.hpp"
 #include "test.hpp"
 
 namespace lex = foonathan::lex;
@@ -286,6 +287,103 @@ TEST_CASE("rule_production: choice with complex peek")
     verify(r3, -1);
 }
 
+TEST_CASE("rule_production: choice dispatch")
+{
+    using grammar = lex::grammar<test_spec, struct P, struct Q>;
+    FOONATHAN_LEX_P(Q, A{} + A{});
+    FOONATHAN_LEX_P(P, B{} >> B{} + C{} | A{} / C{} >> (A{} / C{}) + B{} | Q{} >> Q{}
+                           | else_ >> lex::production_rule::eof);
+
+    {
+        namespace detail = lex::production_rule::detail;
+
+        using token_alternative = detail::choice_alternative<detail::token<A>, detail::token<A>>;
+        REQUIRE(std::is_same<token_alternative::leading_tokens, lex::detail::type_list<A>>::value);
+        REQUIRE(token_alternative::is_decisive::value);
+
+        using sequence_alternative
+            = detail::choice_alternative<detail::token_sequence<detail::token<A>, detail::token<B>>,
+                                         detail::token<A>>;
+        REQUIRE(
+            std::is_same<sequence_alternative::leading_tokens, lex::detail::type_list<A>>::value);
+        REQUIRE(!sequence_alternative::is_decisive::value);
+
+        using production_alternative
+            = detail::choice_alternative<detail::production<Q>, detail::token<A>>;
+        REQUIRE(std::is_same<production_alternative::leading_tokens,
+                             lex::detail::type_list<detail::any_token>>::value);
+        REQUIRE(!production_alternative::is_decisive::value);
+    }
+
+    struct visitor
+    {
+        constexpr int operator()(Q, lex::static_token<A>, lex::static_token<A>) const
+        {
+            return 3;
+        }
+
+        constexpr int operator()(P, lex::static_token<B>, lex::static_token<C>) const
+        {
+            return 1;
+        }
+        constexpr int operator()(P, lex::static_token<A>, lex::static_token<B>) const
+        {
+            return 2;
+        }
+        constexpr int operator()(P, lex::static_token<C>, lex::static_token<B>) const
+        {
+            return 2;
+        }
+        constexpr int operator()(P, int value) const
+        {
+            return value;
+        }
+        constexpr int operator()(P) const
+        {
+            return 4;
+        }
+
+        constexpr void operator()(lex::unexpected_token<grammar, Q, A>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+        constexpr void operator()(lex::unexpected_token<grammar, P, B>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+        constexpr void operator()(lex::unexpected_token<grammar, P, C>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+        constexpr void operator()(lex::unexpected_token<grammar, P, lex::eof_token>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+        constexpr void operator()(lex::exhausted_token_choice<grammar, P, A, C>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+
+        constexpr void operator()(lex::exhausted_choice<grammar, P>,
+                                  const lex::tokenizer<test_spec>&) const
+        {}
+    };
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r0 = parse<P>(visitor{}, "bc");
+    verify(r0, 1);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r1 = parse<P>(visitor{}, "ab");
+    verify(r1, 2);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r2 = parse<P>(visitor{}, "cb");
+    verify(r2, 2);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r3 = parse<P>(visitor{}, "");
+    verify(r3, 4);
+
+    // decided by the first token, so errors aren't recovered by later alternatives
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r4 = parse<P>(visitor{}, "ba");
+    verify(r4, -1);
+
+    FOONATHAN_LEX_TEST_CONSTEXPR auto r5 = parse<P>(visitor{}, "aa");
+    verify(r5, -1);
+}
+
 TEST_CASE("rule_production: right recursion")
 {
     using grammar = lex::grammar<test_spec, struct P>;
@@ -501,3 +599,20 @@ TEST_CASE("rule_production: indirect recursion")
     FOONATHAN_LEX_TEST_CONSTEXPR auto r6 = parse<P>(visitor{}, "abc");
     verify(r6, -1);
 }
+
+TEST_CASE("rule_production: extern parser")
+{
+    // only declared in this translation unit, defined in extern_grammar.cpp
+    using extern_grammar::grammar;
+    static_assert(lex::detail::callback_extern_parser<extern_grammar::visitor>::value, "");
+    static_assert(lex::detail::has_extern_parser<grammar, extern_grammar::visitor>::value, "");
+
+    lex::tokenizer<extern_grammar::spec> tokenizer("abcabc");
+    extern_grammar::visitor              v;
+    auto                                 result = lex::parse<grammar>(tokenizer, v);
+    REQUIRE(result.is_success());
+    REQUIRE(result.value() == 2);
+
+    lex::tokenizer<extern_grammar::spec> invalid("abca");
+    REQUIRE(!lex::parse<grammar>(invalid, extern_grammar::visitor{}).is_success());
+}
@@ -217,6 +217,26 @@ TEST_CASE("rule_production: token choice")
     verify(r4, -1);
 }
 
+TEST_CASE("rule_production: token choice dispatch")
+{
+    namespace detail = lex::production_rule::detail;
+
+    using dispatch = detail::token_choice_dispatch<
+        test_spec, detail::token<B>, detail::token_sequence<detail::token<C>, detail::token<A>>,
+        detail::token_sequence<>>;
+    auto get = [](auto token) {
+        return std::size_t(dispatch::value.alternative[lex::token_kind<test_spec>(token).get()]);
+    };
+    REQUIRE(get(B{}) == 0);
+    REQUIRE(get(C{}) == 1);
+    REQUIRE(get(A{}) == 2);
+    REQUIRE(get(lex::eof_token{}) == 2);
+    REQUIRE(get(lex::error_token{}) == 2);
+
+    using no_catch_all = detail::token_choice_dispatch<test_spec, detail::token<A>>;
+    REQUIRE(no_catch_all::value.alternative[lex::token_kind<test_spec>(B{}).get()] == 1);
+}
+
 TEST_CASE("rule_production: token opt")
 {
     using grammar = lex::grammar<test_spec, struct P>;
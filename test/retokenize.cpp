@@ -0,0 +1,221 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/retokenize.hpp>
+
+#include <catch.hpp>
+#include <string>
+
+#include "test.hpp"
+#include <foonathan/lex/ascii.hpp>
+
+namespace
+{
+namespace lex = foonathan::lex;
+
+using test_spec = lex::token_spec<struct whitespace, struct string, struct comment, struct digits,
+                                  struct token_a, struct token_ab, struct token_abc, struct slash,
+                                  struct dot, struct ellipsis>;
+
+struct whitespace : lex::rule_token<whitespace, test_spec>, lex::whitespace_token
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::star(lex::ascii::is_space);
+    }
+};
+
+struct string : lex::rule_token<string, test_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return '"' + lex::token_rule::until('"');
+    }
+};
+
+struct digits : lex::rule_token<digits, test_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::plus(lex::ascii::is_digit);
+    }
+};
+
+struct token_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct token_ab : FOONATHAN_LEX_LITERAL("ab")
+{};
+
+struct token_abc : FOONATHAN_LEX_LITERAL("abc")
+{};
+
+struct slash : FOONATHAN_LEX_LITERAL("/")
+{};
+
+struct dot : FOONATHAN_LEX_LITERAL(".")
+{};
+
+struct ellipsis : FOONATHAN_LEX_LITERAL("...")
+{};
+
+struct comment : lex::rule_token<comment, test_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return "/*" + lex::token_rule::until("*/");
+    }
+
+    static constexpr bool is_conflicting_literal(lex::token_kind<test_spec> kind) noexcept
+    {
+        return kind == slash{};
+    }
+};
+
+std::vector<lex::token<test_spec>> tokenize(const std::string& input)
+{
+    std::vector<lex::token<test_spec>> result;
+    for (lex::tokenizer<test_spec> tokenizer(input.data(), input.size()); !tokenizer.is_done();)
+        result.push_back(tokenizer.get());
+    return result;
+}
+
+// returns the number of tokens that were tokenized again
+std::size_t verify(const std::string& input, std::size_t offset, std::size_t length,
+                   const std::string& replacement)
+{
+    INFO(input);
+    INFO(offset);
+    INFO(replacement);
+
+    auto edited = input;
+    edited.replace(offset, length, replacement);
+
+    auto old = lex::tokenize_with_lookahead<test_spec>(input.data(), input.data() + input.size());
+    REQUIRE(old.tokens.size() == tokenize(input).size());
+    REQUIRE(old.lookahead.size() == old.tokens.size());
+
+    auto& old_tokens = old.tokens;
+    auto  result = lex::retokenize(old_tokens, old.lookahead, input.data(), edited.data(),
+                                  edited.data() + edited.size(),
+                                  lex::text_edit{offset, length, replacement.size()});
+    REQUIRE(result.begin <= result.end);
+    REQUIRE(result.end <= old_tokens.size());
+    REQUIRE(result.lookahead.size() == result.tokens.size());
+
+    // apply the result to the old tokens
+    std::vector<lex::token<test_spec>> actual;
+    std::vector<std::size_t>           actual_lookahead;
+    for (auto i = 0u; i != result.begin; ++i)
+    {
+        actual.push_back(old_tokens[i]);
+        actual_lookahead.push_back(old.lookahead[i]);
+    }
+    actual.insert(actual.end(), result.tokens.begin(), result.tokens.end());
+    actual_lookahead.insert(actual_lookahead.end(), result.lookahead.begin(),
+                            result.lookahead.end());
+    for (auto i = result.end; i != old_tokens.size(); ++i)
+    {
+        actual.push_back(old_tokens[i]);
+        actual_lookahead.push_back(old.lookahead[i]);
+    }
+
+    auto expected
+        = lex::tokenize_with_lookahead<test_spec>(edited.data(), edited.data() + edited.size());
+    REQUIRE(expected.tokens.size() == tokenize(edited).size());
+    REQUIRE(actual.size() == expected.tokens.size());
+    for (auto i = 0u; i != actual.size(); ++i)
+    {
+        INFO(i);
+        auto new_offset = expected.tokens[i].spelling().data() - edited.data();
+        auto old_offset = [&] {
+            if (i < result.begin)
+                // unchanged token before the edit
+                return actual[i].spelling().data() - input.data();
+            else if (i < result.begin + result.tokens.size())
+                // new token
+                return actual[i].spelling().data() - edited.data();
+            else
+                // unchanged token after the edit
+                return actual[i].spelling().data() - input.data() + result.shift;
+        }();
+        REQUIRE(actual[i].kind() == expected.tokens[i].kind());
+        REQUIRE(old_offset == new_offset);
+        REQUIRE(actual[i].spelling().size() == expected.tokens[i].spelling().size());
+        REQUIRE(actual_lookahead[i] == expected.lookahead[i]);
+    }
+
+    return result.tokens.size();
+}
+} // namespace
+
+TEST_CASE("retokenize")
+{
+    std::string input = "abc ab \"a b c\" 123 a";
+
+    SECTION("no change")
+    {
+        REQUIRE(verify(input, 0, 0, "") <= 1u);
+        REQUIRE(verify(input, 4, 0, "") <= 1u);
+        REQUIRE(verify(input, input.size(), 0, "") <= 1u);
+    }
+    SECTION("insert")
+    {
+        REQUIRE(verify(input, 0, 0, "a ") == 1u);
+        REQUIRE(verify(input, 3, 0, " 42") == 2u);
+        REQUIRE(verify(input, 18, 0, "4") == 1u);
+        REQUIRE(verify(input, input.size(), 0, "bc") == 1u);
+
+        // merges two tokens
+        REQUIRE(verify(input, 3, 1, "") == 1u);
+        // opens a string that swallows the rest
+        verify(input, 7, 1, "");
+    }
+    SECTION("erase")
+    {
+        REQUIRE(verify(input, 0, 4, "") == 0u);
+        REQUIRE(verify(input, 2, 1, "") == 1u);
+        REQUIRE(verify(input, 6, 8, "") == 1u);
+        verify(input, 0, input.size(), "");
+    }
+    SECTION("replace")
+    {
+        REQUIRE(verify(input, 1, 1, "") == 2u);
+        REQUIRE(verify(input, 15, 3, "9") == 1u);
+        verify(input, 0, input.size(), "a b c");
+    }
+    SECTION("long")
+    {
+        std::string long_input;
+        for (auto i = 0; i != 1000; ++i)
+            long_input += "abcab 12 \"ab 12 abc\" aaa\n";
+
+        // only a couple of tokens have to be tokenized again
+        REQUIRE(verify(long_input, 5000, 0, "1") <= 3u);
+        REQUIRE(verify(long_input, 5000, 3, "42") <= 3u);
+        REQUIRE(verify(long_input, 7000, 25, "") <= 3u);
+
+        // but an unbalanced quote changes everything after it
+        REQUIRE(verify(long_input, 5000, 0, "\"") > 1000u);
+    }
+}
+
+TEST_CASE("retokenize with lookahead")
+{
+    SECTION("literal")
+    {
+        // the first dot has looked at the x
+        REQUIRE(verify("..x", 2, 1, ".") == 1u);
+        REQUIRE(verify(". .x", 3, 1, ".") == 2u);
+        REQUIRE(verify("...", 2, 1, "x") == 3u);
+    }
+    SECTION("comment")
+    {
+        // the slash has looked for the end of the comment until the end of the input
+        REQUIRE(verify("/* abc *x", 8, 1, "/") == 1u);
+        REQUIRE(verify("/* abc *x a", 8, 1, "/") == 1u);
+        verify("/* abc */ a", 8, 1, "x");
+        verify("abc /* abc */ a", 14, 0, "*/");
+    }
+}
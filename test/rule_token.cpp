@@ -170,6 +170,11 @@ bool verify(const char (&str)[N], std::size_t length)
         return result.is_success() && result.bump == length;
 }
 
+bool runtime_predicate(char c) noexcept
+{
+    return c == 'a' || c == 'b';
+}
+
 #define FOONATHAN_LEX_PEG(...)                                                                     \
     struct PEG                                                                                     \
     {                                                                                              \
@@ -219,6 +224,14 @@ TEST_CASE("rule_token")
             REQUIRE(verify<PEG>("ba", 1));
             REQUIRE(verify<PEG>("c", 0));
         }
+        SECTION("non-constexpr predicate")
+        {
+            FOONATHAN_LEX_PEG(plus(runtime_predicate));
+
+            REQUIRE(verify<PEG>("aba", 3));
+            REQUIRE(verify<PEG>("abc", 2));
+            REQUIRE(verify<PEG>("c", 0));
+        }
         SECTION("callable")
         {
             struct callable
@@ -327,6 +340,48 @@ TEST_CASE("rule_token")
             REQUIRE(verify<PEG>("b", 0));
             REQUIRE(verify<PEG>("", 0));
         }
+        SECTION("character class")
+        {
+            struct predicate
+            {
+                constexpr bool operator()(char c) const noexcept
+                {
+                    return c >= 'a' && c <= 'z';
+                }
+            };
+            FOONATHAN_LEX_PEG(r(predicate{}) + star(r(predicate{}) / '_' / '0'));
+
+            using compiled = decltype(lex::token_rule::detail::compile_rule(PEG::rule()));
+            using expected = lex::token_rule::detail::sequence<
+                lex::token_rule::detail::char_class_rule, lex::token_rule::detail::char_class_star>;
+            REQUIRE(std::is_same<compiled, expected>::value);
+
+            REQUIRE(verify<PEG>("a", 1));
+            REQUIRE(verify<PEG>("a_0b", 4));
+            REQUIRE(verify<PEG>("ab_c-d", 4));
+            REQUIRE(verify<PEG>("ab1", 2));
+            REQUIRE(verify<PEG>("_a", 0));
+            REQUIRE(verify<PEG>("0", 0));
+            REQUIRE(verify<PEG>("", 0));
+        }
+        SECTION("run")
+        {
+            struct predicate
+            {
+                constexpr bool operator()(char c) const noexcept
+                {
+                    return c >= 'a' && c <= 'z';
+                }
+            };
+            FOONATHAN_LEX_PEG(run(r(predicate{}) / '_'));
+
+            REQUIRE(verify<PEG>("a", 1));
+            REQUIRE(verify<PEG>("ab_c-d", 4));
+            REQUIRE(verify<PEG>("abcdefghijklmnopqrstuvwxyz_abcdefghijklmnopqrstuvwxyz_abc", 57));
+            REQUIRE(verify<PEG>("abcdefghijklmnopqrstuvwxyz_abcdefghijklmnopqrstuvwxyz_ab!c", 56));
+            REQUIRE(verify<PEG>("-a", 0));
+            REQUIRE(verify<PEG>("", 0));
+        }
         SECTION("lookahead")
         {
             FOONATHAN_LEX_PEG(lookahead("ab") + 'a');
@@ -382,6 +437,46 @@ TEST_CASE("rule_token")
             REQUIRE(verify<PEG>("ab b", 0));
             REQUIRE(verify<PEG>("aaaaa", 0));
         }
+        SECTION("until character")
+        {
+            FOONATHAN_LEX_PEG('a' + until('c'));
+
+            REQUIRE(verify<PEG>("abbbc", 5));
+            REQUIRE(verify<PEG>("acc", 2));
+            REQUIRE(verify<PEG>("ac", 2));
+            REQUIRE(verify<PEG>("abbb", 0));
+        }
+        SECTION("until string")
+        {
+            FOONATHAN_LEX_PEG("/*" + until("*/"));
+
+            REQUIRE(verify<PEG>("/* a * b / c */ d */", 15));
+            REQUIRE(verify<PEG>("/**/", 4));
+            REQUIRE(verify<PEG>("/*/", 0));
+            REQUIRE(verify<PEG>("/* abc *", 0));
+        }
+        SECTION("until predicate")
+        {
+            struct predicate
+            {
+                constexpr bool operator()(char c) const noexcept
+                {
+                    return c == '\n' || c == '\r';
+                }
+            };
+
+            FOONATHAN_LEX_PEG("//" + until_excluding(predicate{}));
+
+            REQUIRE(verify<PEG>("// abc\n", 6));
+            REQUIRE(verify<PEG>("// abc\r\n", 6));
+            REQUIRE(verify<PEG>("//\n", 2));
+            REQUIRE(verify<PEG>("// abc", 0));
+
+            // longer than a vector, so the end is searched vectorized
+            REQUIRE(verify<PEG>("// a comment that is longer than a vector block\n", 47));
+            REQUIRE(verify<PEG>("// a comment that is longer than a vector block\r\n", 47));
+            REQUIRE(verify<PEG>("// a comment that is longer than a vector block", 0));
+        }
         SECTION("list")
         {
             FOONATHAN_LEX_PEG(list('a', ' '));
@@ -0,0 +1,241 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/streaming_tokenizer.hpp>
+
+#include <catch.hpp>
+#include <string>
+#include <vector>
+
+#include "test.hpp"
+#include <foonathan/lex/ascii.hpp>
+
+namespace
+{
+namespace lex = foonathan::lex;
+
+using test_spec = lex::token_spec<struct whitespace, struct digits, struct token_a, struct token_ab,
+                                  struct token_abc>;
+
+struct whitespace : lex::rule_token<whitespace, test_spec>, lex::whitespace_token
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::star(lex::ascii::is_blank);
+    }
+};
+
+struct digits : lex::rule_token<digits, test_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::plus(lex::ascii::is_digit);
+    }
+};
+
+struct token_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct token_ab : FOONATHAN_LEX_LITERAL("ab")
+{};
+
+struct token_abc : FOONATHAN_LEX_LITERAL("abc")
+{};
+
+// tokens whose match looks further ahead than their end
+using lookahead_spec = lex::token_spec<struct lookahead_whitespace, struct dot, struct ellipsis,
+                                       struct slash, struct comment>;
+
+struct lookahead_whitespace : lex::rule_token<lookahead_whitespace, lookahead_spec>,
+                              lex::whitespace_token
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::star(lex::ascii::is_blank);
+    }
+};
+
+struct dot : FOONATHAN_LEX_LITERAL(".")
+{};
+
+struct ellipsis : FOONATHAN_LEX_LITERAL("...")
+{};
+
+struct slash : FOONATHAN_LEX_LITERAL("/")
+{};
+
+struct comment : lex::rule_token<comment, lookahead_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return "/*" + lex::token_rule::until("*/");
+    }
+
+    static constexpr bool is_conflicting_literal(lex::token_kind<lookahead_spec> kind) noexcept
+    {
+        return kind == slash{};
+    }
+};
+
+template <class Spec>
+struct result_token
+{
+    lex::token_kind<Spec> kind;
+    std::string           spelling;
+};
+
+template <class Spec = test_spec>
+std::vector<result_token<Spec>> tokenize(const std::string& input)
+{
+    std::vector<result_token<Spec>> result;
+    for (lex::tokenizer<Spec> tokenizer(input.data(), input.size()); !tokenizer.is_done();)
+    {
+        auto token = tokenizer.get();
+        result.push_back(
+            {token.kind(), std::string(token.spelling().data(), token.spelling().size())});
+    }
+    return result;
+}
+
+// feeds the input in chunks of the given sizes, the last chunk is the rest
+template <class Spec = test_spec>
+std::vector<result_token<Spec>> tokenize_chunked(const std::string&              input,
+                                                 const std::vector<std::size_t>& sizes)
+{
+    std::vector<result_token<Spec>> result;
+    lex::streaming_tokenizer<Spec>  tokenizer;
+
+    std::size_t offset = 0;
+    for (auto i = 0u; i <= sizes.size(); ++i)
+    {
+        // copy the chunk, so we can release it afterwards
+        auto size  = i == sizes.size() ? input.size() - offset : sizes[i];
+        auto chunk = input.substr(offset, size);
+        offset += size;
+
+        REQUIRE(tokenizer.needs_input());
+        tokenizer.feed(chunk.data(), chunk.size());
+        while (!tokenizer.needs_input())
+        {
+            auto token = tokenizer.get();
+            result.push_back({token.kind(), std::string(token.spelling().data(),
+                                                        token.spelling().size())});
+        }
+    }
+
+    tokenizer.finish();
+    while (!tokenizer.is_done())
+    {
+        REQUIRE(!tokenizer.needs_input());
+        auto token = tokenizer.get();
+        result.push_back(
+            {token.kind(), std::string(token.spelling().data(), token.spelling().size())});
+    }
+
+    return result;
+}
+
+template <class Spec>
+void verify(const std::vector<result_token<Spec>>& actual,
+            const std::vector<result_token<Spec>>& expected)
+{
+    REQUIRE(actual.size() == expected.size());
+    for (auto i = 0u; i != actual.size(); ++i)
+    {
+        INFO(i);
+        REQUIRE(actual[i].kind == expected[i].kind);
+        REQUIRE(actual[i].spelling == expected[i].spelling);
+    }
+}
+} // namespace
+
+TEST_CASE("streaming_tokenizer")
+{
+    std::string input    = "abc ab  a 12345 abcab 1a  x ab";
+    auto        expected = tokenize(input);
+    REQUIRE(expected.size() == 10);
+
+    SECTION("single chunk")
+    {
+        verify(tokenize_chunked(input, {}), expected);
+    }
+    SECTION("two chunks")
+    {
+        for (auto split = 0u; split <= input.size(); ++split)
+        {
+            INFO(split);
+            verify(tokenize_chunked(input, {split}), expected);
+        }
+    }
+    SECTION("three chunks")
+    {
+        for (auto first = 0u; first <= input.size(); ++first)
+            for (auto second = 0u; first + second <= input.size(); ++second)
+            {
+                INFO(first << " " << second);
+                verify(tokenize_chunked(input, {first, second}), expected);
+            }
+    }
+    SECTION("single characters")
+    {
+        verify(tokenize_chunked(input, std::vector<std::size_t>(input.size(), 1u)), expected);
+    }
+    SECTION("long token")
+    {
+        auto long_input = "a " + std::string(1000, '1') + " a";
+        verify(tokenize_chunked(long_input, {10, 100, 500}), tokenize(long_input));
+        verify(tokenize_chunked(long_input, {10, 990}), tokenize(long_input));
+    }
+    SECTION("empty")
+    {
+        lex::streaming_tokenizer<test_spec> tokenizer;
+        REQUIRE(tokenizer.needs_input());
+        tokenizer.finish();
+        REQUIRE(tokenizer.is_done());
+        REQUIRE(tokenizer.peek().is(lex::eof_token{}));
+    }
+}
+
+TEST_CASE("streaming_tokenizer with lookahead")
+{
+    SECTION("longer literal")
+    {
+        auto expected = tokenize<lookahead_spec>("...");
+        REQUIRE(expected.size() == 1);
+        REQUIRE(expected[0].kind == ellipsis{});
+
+        verify(tokenize_chunked<lookahead_spec>("...", {2}), expected);
+        verify(tokenize_chunked<lookahead_spec>("...", {1, 1}), expected);
+    }
+    SECTION("literal prefix")
+    {
+        auto expected = tokenize<lookahead_spec>(". ..");
+        REQUIRE(expected.size() == 3);
+        REQUIRE(expected[0].kind == dot{});
+
+        verify(tokenize_chunked<lookahead_spec>(". ..", {3}), expected);
+        verify(tokenize_chunked<lookahead_spec>(". ..", {1, 1, 1}), expected);
+    }
+    SECTION("comment")
+    {
+        auto expected = tokenize<lookahead_spec>("/* ab */.");
+        REQUIRE(expected.size() == 2);
+        REQUIRE(expected[0].kind == comment{});
+        REQUIRE(expected[1].kind == dot{});
+
+        verify(tokenize_chunked<lookahead_spec>("/* ab */.", {5}), expected);
+        verify(tokenize_chunked<lookahead_spec>("/* ab */.", {1, 6}), expected);
+        for (auto split = 0u; split <= 9u; ++split)
+        {
+            INFO(split);
+            verify(tokenize_chunked<lookahead_spec>("/* ab */.", {split}), expected);
+        }
+    }
+    SECTION("unterminated comment")
+    {
+        auto input = "/* ab * / .";
+        verify(tokenize_chunked<lookahead_spec>(input, {4}), tokenize<lookahead_spec>(input));
+        verify(tokenize_chunked<lookahead_spec>(input, {8, 1}), tokenize<lookahead_spec>(input));
+    }
+}
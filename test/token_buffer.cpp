@@ -0,0 +1,143 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/token_buffer.hpp>
+
+#include "tokenize.hpp"
+#include <catch.hpp>
+
+namespace
+{
+using test_spec = lex::token_spec<struct token_a, struct token_bc, struct whitespace>;
+
+struct token_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct token_bc : FOONATHAN_LEX_LITERAL("bc")
+{};
+
+struct whitespace : FOONATHAN_LEX_LITERAL(" "), lex::whitespace_token
+{};
+
+template <std::size_t Capacity>
+struct storage
+{
+    lex::token_kind<test_spec> kinds[Capacity];
+    std::size_t                offsets[Capacity];
+    std::size_t                lengths[Capacity];
+
+    lex::token_buffer<test_spec> buffer() noexcept
+    {
+        return lex::token_buffer<test_spec>(kinds, offsets, lengths, Capacity);
+    }
+};
+
+template <class Token>
+void verify(const lex::token_buffer<test_spec>& buffer, std::size_t i, std::size_t offset,
+            std::size_t length)
+{
+    REQUIRE(buffer.kinds()[i].is(Token{}));
+    REQUIRE(buffer.offsets()[i] == offset);
+    REQUIRE(buffer.lengths()[i] == length);
+
+    REQUIRE(buffer[i].is(Token{}));
+    REQUIRE(buffer[i].spelling().data() == buffer.begin_ptr() + offset);
+    REQUIRE(buffer[i].spelling().size() == length);
+}
+
+constexpr std::size_t count_tokens(const char* str, std::size_t size)
+{
+    lex::token_kind<test_spec>   kinds[8]{};
+    std::size_t                  offsets[8]{};
+    std::size_t                  lengths[8]{};
+    lex::token_buffer<test_spec> buffer(kinds, offsets, lengths, 8);
+
+    lex::tokenize_all(str, str + size, buffer);
+    return buffer.size();
+}
+} // namespace
+
+TEST_CASE("tokenize_all")
+{
+    static constexpr const char array[] = " abc  bcx a ";
+    auto                        end     = array + sizeof(array) - 1;
+
+    SECTION("everything fits")
+    {
+        storage<8> s;
+        auto       buffer = s.buffer();
+
+        auto result = lex::tokenize_all(array, end, buffer);
+        REQUIRE(result == end);
+        REQUIRE(buffer.size() == 5);
+        REQUIRE(buffer.begin_ptr() == array);
+
+        verify<token_a>(buffer, 0, 1, 1);
+        verify<token_bc>(buffer, 1, 2, 2);
+        verify<token_bc>(buffer, 2, 6, 2);
+        verify<lex::error_token>(buffer, 3, 8, 1);
+        verify<token_a>(buffer, 4, 10, 1);
+
+        // tokenizing again replaces the tokens
+        result = lex::tokenize_all(array + 6, end, buffer);
+        REQUIRE(result == end);
+        REQUIRE(buffer.size() == 3);
+        verify<token_bc>(buffer, 0, 0, 2);
+    }
+    SECTION("buffer full")
+    {
+        storage<2> s;
+        auto       buffer = s.buffer();
+
+        auto result = lex::tokenize_all(array, end, buffer);
+        REQUIRE(result == array + 6);
+        REQUIRE(buffer.full());
+
+        verify<token_a>(buffer, 0, 1, 1);
+        verify<token_bc>(buffer, 1, 2, 2);
+    }
+    SECTION("empty")
+    {
+        storage<2> s;
+        auto       buffer = s.buffer();
+
+        auto result = lex::tokenize_all(array, array + 1, buffer);
+        REQUIRE(result == array + 1);
+        REQUIRE(buffer.empty());
+    }
+
+    constexpr auto count = count_tokens(array, sizeof(array) - 1);
+    REQUIRE(count == 5);
+}
+
+TEST_CASE("token_buffer::fill")
+{
+    static constexpr const char array[] = " abc  bcx a ";
+    lex::tokenizer<test_spec>   tokenizer(array);
+
+    storage<4> s;
+    auto       buffer = s.buffer();
+
+    REQUIRE(buffer.fill(tokenizer, 2) == 2);
+    verify<token_a>(buffer, 0, 1, 1);
+    verify<token_bc>(buffer, 1, 2, 2);
+    REQUIRE(tokenizer.current_ptr() == array + 6);
+    REQUIRE(tokenizer.peek().is(token_bc{}));
+
+    // only room for two more
+    REQUIRE(buffer.fill(tokenizer, 5) == 2);
+    REQUIRE(buffer.full());
+    verify<token_bc>(buffer, 2, 6, 2);
+    verify<lex::error_token>(buffer, 3, 8, 1);
+    REQUIRE(tokenizer.current_ptr() == array + 10);
+    REQUIRE(tokenizer.peek().is(token_a{}));
+
+    buffer.clear();
+    REQUIRE(buffer.fill(tokenizer, 5) == 1);
+    verify<token_a>(buffer, 0, 10, 1);
+    REQUIRE(tokenizer.is_done());
+
+    REQUIRE(buffer.fill(tokenizer, 5) == 0);
+    REQUIRE(tokenizer.is_done());
+}
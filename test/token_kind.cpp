@@ -0,0 +1,54 @@
+// Copyright (C) 2018-2019 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <foonathan/lex/token_kind.hpp>
+
+#include <catch.hpp>
+#include <foonathan/lex/literal_token.hpp>
+#include <foonathan/lex/whitespace_token.hpp>
+
+namespace lex = foonathan::lex;
+
+namespace
+{
+using test_spec = lex::token_spec<struct token_a, struct token_b>;
+
+struct token_a : lex::literal_token<'a'>
+{};
+
+struct token_b : lex::literal_token<'b'>, lex::whitespace_token
+{};
+
+template <typename Token>
+struct is_token_a : std::is_same<Token, token_a>
+{};
+} // namespace
+
+TEST_CASE("token_kind")
+{
+    using kind = lex::token_kind<test_spec>;
+
+    REQUIRE(kind(token_a{}).is(token_a{}));
+    REQUIRE(!kind(token_a{}).is(token_b{}));
+    REQUIRE(kind(lex::error_token{}).is(lex::error_token{}));
+    REQUIRE(kind(lex::eof_token{}).is(lex::eof_token{}));
+    REQUIRE(kind(token_b{}) != kind(token_a{}));
+}
+
+TEST_CASE("token_kind::is_category")
+{
+    using kind = lex::token_kind<test_spec>;
+
+    REQUIRE(!kind(token_a{}).is_category<lex::is_whitespace>());
+    REQUIRE(kind(token_b{}).is_category<lex::is_whitespace>());
+    REQUIRE(!kind(lex::error_token{}).is_category<lex::is_whitespace>());
+    REQUIRE(!kind(lex::eof_token{}).is_category<lex::is_whitespace>());
+
+    REQUIRE(kind(token_a{}).is_category<lex::is_literal_token>());
+    REQUIRE(kind(token_b{}).is_category<lex::is_literal_token>());
+
+    constexpr auto user = kind(token_a{}).is_category<is_token_a>();
+    REQUIRE(user);
+    REQUIRE(!kind(token_b{}).is_category<is_token_a>());
+}
@@ -4,9 +4,13 @@
 
 #include <foonathan/lex/tokenizer.hpp>
 
+#include "extern_grammar.hpp"
+#include "tokenize.hpp"
 #include <catch.hpp>
-
-namespace lex = foonathan::lex;
+#include <foonathan/lex/ascii.hpp>
+#include <foonathan/lex/rule_token.hpp>
+#include <string>
+#include <vector>
 
 namespace
 {
@@ -18,6 +22,158 @@ struct token_a : FOONATHAN_LEX_LITERAL("a")
 struct token_bc : FOONATHAN_LEX_LITERAL("bc")
 {};
 
+struct dfa_spec : lex::token_spec<struct dfa_a, struct dfa_ab, struct dfa_abc, struct dfa_space>
+{
+    using backend = lex::dfa_backend;
+};
+
+struct dfa_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct dfa_ab : FOONATHAN_LEX_LITERAL("ab")
+{};
+
+struct dfa_abc : FOONATHAN_LEX_LITERAL("abc")
+{};
+
+struct dfa_space : FOONATHAN_LEX_LITERAL(" "), lex::whitespace_token
+{};
+
+using ws_spec = lex::token_spec<struct ws_space, struct ws_a, struct ws_b>;
+
+struct ws_space : lex::rule_token<ws_space, ws_spec>, lex::whitespace_token
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::plus(lex::ascii::is_blank);
+    }
+};
+
+struct ws_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct ws_b : lex::rule_token<ws_b, ws_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        return lex::token_rule::plus(lex::token_rule::r('b'));
+    }
+};
+
+using lookahead_tokens = lex::token_spec<struct la_space, struct la_a, struct la_bc>;
+
+struct lookahead_spec : lookahead_tokens
+{
+    static constexpr std::size_t lookahead = 4;
+};
+
+struct la_space : FOONATHAN_LEX_LITERAL(" "), lex::whitespace_token
+{};
+
+struct la_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct la_bc : FOONATHAN_LEX_LITERAL("bc")
+{};
+
+struct coalesce_spec : lex::token_spec<struct co_space, struct co_a, struct co_number>
+{
+    static constexpr bool coalesce_errors = true;
+};
+
+struct co_space : FOONATHAN_LEX_LITERAL(" "), lex::whitespace_token
+{};
+
+struct co_a : FOONATHAN_LEX_LITERAL("a")
+{};
+
+struct co_number : lex::rule_token<co_number, coalesce_spec>
+{
+    static constexpr auto rule() noexcept
+    {
+        // can start with '-', but might still fail
+        return lex::token_rule::opt('-') + lex::token_rule::plus(lex::ascii::is_digit);
+    }
+};
+
+template <class Spec>
+void verify_lookahead()
+{
+    static constexpr const char array[] = "a bc  a bc";
+    lex::tokenizer<Spec>        tokenizer(array);
+
+    REQUIRE(tokenizer.peek(0).is(la_a{}));
+    REQUIRE(tokenizer.peek(1).is(la_bc{}));
+    REQUIRE(tokenizer.peek(2).is(la_a{}));
+    REQUIRE(tokenizer.peek(2).spelling().data() == array + 6);
+    REQUIRE(tokenizer.peek(3).is(la_bc{}));
+    REQUIRE(tokenizer.current_ptr() == array);
+
+    auto marker = tokenizer.mark();
+    REQUIRE(marker.position() == array);
+    tokenizer.bump();
+    tokenizer.bump();
+    REQUIRE(tokenizer.current_ptr() == array + 6);
+    REQUIRE(tokenizer.peek(1).is(la_bc{}));
+    REQUIRE(tokenizer.peek(2).is(lex::eof_token{}));
+    REQUIRE(tokenizer.peek(3).is(lex::eof_token{}));
+
+    tokenizer.rewind(marker);
+    REQUIRE(tokenizer.current_ptr() == array);
+    REQUIRE(tokenizer.peek().is(la_a{}));
+    tokenizer.bump();
+    REQUIRE(tokenizer.current_ptr() == array + 2);
+    REQUIRE(tokenizer.peek().is(la_bc{}));
+
+    tokenizer.reset(array + 6);
+    REQUIRE(tokenizer.peek().is(la_a{}));
+    tokenizer.bump();
+    tokenizer.bump();
+    REQUIRE(tokenizer.is_done());
+    REQUIRE(tokenizer.peek(1).is(lex::eof_token{}));
+    tokenizer.bump();
+    REQUIRE(tokenizer.is_done());
+
+    tokenizer.reset(array + 4);
+    REQUIRE(tokenizer.peek().is(la_space{}));
+    tokenizer.bump();
+    REQUIRE(tokenizer.current_ptr() == array + 6);
+    REQUIRE(tokenizer.peek(1).is(la_bc{}));
+
+    // compare with the tokens returned by get()
+    auto input = std::string();
+    for (auto i = 0u; i != 50u; ++i)
+        input += i % 3 == 0 ? "a " : (i % 3 == 1 ? "bc" : "  a");
+
+    std::vector<lex::token<Spec>> tokens;
+    lex::tokenizer<Spec>          sequential(input.data(), input.size());
+    while (!sequential.is_done())
+        tokens.push_back(sequential.get());
+
+    lex::tokenizer<Spec> peeking(input.data(), input.size());
+    for (auto i = 0u; i != tokens.size(); ++i)
+    {
+        for (auto n = 0u; n != 4u; ++n)
+        {
+            auto token = peeking.peek(n);
+            if (i + n < tokens.size())
+                REQUIRE(token.spelling().data() == tokens[i + n].spelling().data());
+            else
+                REQUIRE(token.is(lex::eof_token{}));
+        }
+
+        if (i % 5 == 0)
+        {
+            auto marker = peeking.mark();
+            peeking.bump();
+            peeking.bump();
+            peeking.rewind(marker);
+        }
+        REQUIRE(peeking.get().spelling().data() == tokens[i].spelling().data());
+    }
+    REQUIRE(peeking.is_done());
+}
+
 template <class Token>
 void verify(const lex::tokenizer<test_spec>& tokenizer, const char* ptr, bool is_done)
 {
@@ -61,3 +217,128 @@ TEST_CASE("tokenizer")
     tokenizer.bump();
     verify<lex::eof_token>(tokenizer, array + 8, true);
 }
+
+TEST_CASE("tokenizer with dfa_backend")
+{
+    static constexpr const char       array[]   = "abcab aba x";
+    constexpr auto                    tokenizer = lex::tokenizer<dfa_spec>(array);
+    FOONATHAN_LEX_TEST_CONSTEXPR auto result    = tokenize<dfa_spec>(tokenizer);
+
+    REQUIRE(result.size() == 5);
+
+    REQUIRE(result[0].is(dfa_abc{}));
+    REQUIRE(result[0].offset(tokenizer) == 0);
+
+    REQUIRE(result[1].is(dfa_ab{}));
+    REQUIRE(result[1].offset(tokenizer) == 3);
+
+    REQUIRE(result[2].is(dfa_ab{}));
+    REQUIRE(result[2].offset(tokenizer) == 6);
+
+    REQUIRE(result[3].is(dfa_a{}));
+    REQUIRE(result[3].offset(tokenizer) == 8);
+
+    REQUIRE(result[4].is(lex::error_token{}));
+    REQUIRE(result[4].spelling() == "x");
+}
+
+TEST_CASE("tokenizer whitespace skipping")
+{
+    // the whitespace token is a character class repetition, so it is skipped without the trie
+    REQUIRE(lex::detail::whitespace_char_class<ws_space>::is_valid);
+
+    auto input = std::string("a") + std::string(40, ' ') + "bb \t a" + std::string(70, '\t');
+    lex::tokenizer<ws_spec> tokenizer(input.data(), input.size());
+
+    REQUIRE(tokenizer.peek().is(ws_a{}));
+    tokenizer.bump();
+
+    REQUIRE(tokenizer.current_ptr() == input.data() + 41);
+    REQUIRE(tokenizer.peek().is(ws_b{}));
+    REQUIRE(tokenizer.peek().spelling() == "bb");
+    tokenizer.bump();
+
+    REQUIRE(tokenizer.current_ptr() == input.data() + 46);
+    REQUIRE(tokenizer.peek().is(ws_a{}));
+    tokenizer.bump();
+
+    REQUIRE(tokenizer.is_done());
+    REQUIRE(tokenizer.current_ptr() == input.data() + input.size());
+
+    // leading whitespace is only skipped by the constructor
+    tokenizer.reset(input.data() + 1);
+    REQUIRE(tokenizer.peek().is(ws_space{}));
+    REQUIRE(tokenizer.peek().spelling().size() == 40);
+}
+
+TEST_CASE("tokenizer lookahead")
+{
+    SECTION("without cache")
+    {
+        verify_lookahead<lookahead_tokens>();
+    }
+    SECTION("with cache")
+    {
+        verify_lookahead<lookahead_spec>();
+    }
+}
+
+TEST_CASE("tokenizer error coalescing")
+{
+    auto can_start = [](char c) {
+        using error_chars = lex::detail::token_spec_error_chars<coalesce_spec>;
+        return !error_chars::value.contains[static_cast<unsigned char>(c)];
+    };
+    REQUIRE(can_start(' '));
+    REQUIRE(can_start('a'));
+    REQUIRE(can_start('-'));
+    REQUIRE(can_start('0'));
+    REQUIRE(can_start('9'));
+    REQUIRE(!can_start('b'));
+    REQUIRE(!can_start('\x80'));
+
+    auto input = std::string("bcd a xy--z-1 ") + std::string(100, '?') + "\x80\xFF" "a";
+    lex::tokenizer<coalesce_spec> tokenizer(input.data(), input.size());
+
+    auto token = tokenizer.get();
+    REQUIRE(token.is(lex::error_token{}));
+    REQUIRE(token.spelling() == "bcd");
+    REQUIRE(tokenizer.get().is(co_a{}));
+
+    // '-' can start a number, but the error continues after it
+    token = tokenizer.get();
+    REQUIRE(token.is(lex::error_token{}));
+    REQUIRE(token.spelling() == "xy--z");
+
+    token = tokenizer.get();
+    REQUIRE(token.is(co_number{}));
+    REQUIRE(token.spelling() == "-1");
+
+    token = tokenizer.get();
+    REQUIRE(token.is(lex::error_token{}));
+    REQUIRE(token.spelling().size() == 102);
+    REQUIRE(tokenizer.get().is(co_a{}));
+    REQUIRE(tokenizer.is_done());
+}
+
+TEST_CASE("tokenizer with extern matcher")
+{
+    // only declared in this translation unit, defined in extern_grammar.cpp
+    using extern_spec = extern_grammar::spec;
+    static_assert(lex::detail::token_spec_extern_tokenizer<extern_spec>::value, "");
+    static_assert(lex::detail::has_extern_matcher<extern_spec>::value, "");
+
+    const char                  array[] = "abc aabc";
+    lex::tokenizer<extern_spec> tokenizer(array);
+
+    auto result = tokenize<extern_spec>(tokenizer);
+    REQUIRE(result.size() == 6);
+    REQUIRE(result[0].is(extern_grammar::token_a{}));
+    REQUIRE(result[1].is(extern_grammar::token_bc{}));
+    REQUIRE(result[2].is(lex::error_token{}));
+    REQUIRE(result[2].spelling() == " ");
+    REQUIRE(result[3].is(extern_grammar::token_a{}));
+    REQUIRE(result[4].is(extern_grammar::token_a{}));
+    REQUIRE(result[5].is(extern_grammar::token_bc{}));
+    REQUIRE(result[5].offset(tokenizer) == 6);
+}